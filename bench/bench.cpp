@@ -0,0 +1,300 @@
+/*
+ *  Micro-benchmarks for the engine's hot primitives, run over the fixed corpus of positions in
+ * bench/positions.fen. Use --benchmark_format=json or --benchmark_out=<file> for machine-readable
+ * results and scripts/compare_bench.py to compare two runs.
+ */
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "evaluate.h"
+#include "training.h"
+
+// Loaded once, then copied by each benchmark that writes to the boards
+static const std::vector<Board>& corpus() {
+    static std::vector<Board> boards;
+    if(boards.empty()) {
+        std::ifstream in(CHESS_BENCH_POSITIONS);
+        std::string line;
+        while(std::getline(in, line)) {
+            if(!line.empty()) {
+                boards.push_back(Board(line));
+            }
+        }
+    }
+    return boards;
+}
+
+// Legal moves of every corpus position, for benchmarks which work per move
+static const std::vector<std::list<Move>>& corpusMoves() {
+    static std::vector<std::list<Move>> moves;
+    if(moves.empty()) {
+        std::vector<Board> boards = corpus();
+        moves.resize(boards.size());
+        for(size_t i = 0; i < boards.size(); i++) {
+            boards[i].generateLegalMoves(moves[i]);
+        }
+    }
+    return moves;
+}
+
+// Pseudo-legal generation for one piece type, through the same per-piece generators Board uses
+static void BM_GeneratePieceMoves(benchmark::State& state, char type) {
+    std::vector<Board> boards = corpus();
+    // The pieces to generate for, found once up front
+    std::vector<std::vector<Piece>> pieces(boards.size());
+    for(size_t i = 0; i < boards.size(); i++) {
+        for(unsigned int r = 0; r < 8; r++) {
+            for(unsigned int c = 0; c < 8; c++) {
+                if(boards[i].getPiece(r,c).pieceType == type) {
+                    pieces[i].push_back(boards[i].getPiece(r,c));
+                }
+            }
+        }
+    }
+    int64_t calls = 0;
+    MoveList moves;
+    for(auto _ : state) {
+        for(size_t i = 0; i < boards.size(); i++) {
+            for(const Piece& p : pieces[i]) {
+                moves.clear();
+                boards[i].generateMoves(&p, moves);
+                benchmark::DoNotOptimize(moves.size());
+            }
+            calls += pieces[i].size();
+        }
+    }
+    state.SetItemsProcessed(calls);
+}
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, pawn, 'p');
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, knight, 'n');
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, bishop, 'b');
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, rook, 'r');
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, queen, 'q');
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, king, 'k');
+
+static void BM_GenerateLegalMoves(benchmark::State& state) {
+    std::vector<Board> boards = corpus();
+    for(auto _ : state) {
+        for(Board& b : boards) {
+            std::list<Move> moves;
+            b.generateLegalMoves(moves);
+            benchmark::DoNotOptimize(moves.size());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_GenerateLegalMoves);
+
+// Staged generation for the side to move, one category at a time: 0 captures, 1 quiets, 2 quiet checks
+static void BM_GenerateStaged(benchmark::State& state) {
+    std::vector<Board> boards = corpus();
+    MoveList moves;
+    for(auto _ : state) {
+        for(Board& b : boards) {
+            moves.clear();
+            switch(state.range(0)) {
+                case 0: b.generateCaptures(moves); break;
+                case 1: b.generateQuiets(moves); break;
+                case 2: b.generateQuietChecks(moves); break;
+            }
+            benchmark::DoNotOptimize(moves.size());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_GenerateStaged)->DenseRange(0, 2);
+
+static void BM_AttackMaps(benchmark::State& state) {
+    std::vector<Board> boards = corpus();
+    for(auto _ : state) {
+        for(Board& b : boards) {
+            b.updateAttacks();
+            benchmark::DoNotOptimize(b.getAttacks(true) | b.getAttacks(false));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_AttackMaps);
+
+static void BM_IsCheck(benchmark::State& state) {
+    const std::vector<Board>& boards = corpus();
+    for(auto _ : state) {
+        for(const Board& b : boards) {
+            benchmark::DoNotOptimize(b.isCheck(b.isWhiteToMove()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_IsCheck);
+
+static void BM_CausesCheck(benchmark::State& state) {
+    std::vector<Board> boards = corpus();
+    const std::vector<std::list<Move>>& moves = corpusMoves();
+    int64_t count = 0;
+    for(auto _ : state) {
+        for(size_t i = 0; i < boards.size(); i++) {
+            for(const Move& m : moves[i]) {
+                benchmark::DoNotOptimize(boards[i].causesCheck(m));
+            }
+            count += moves[i].size();
+        }
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(BM_CausesCheck);
+
+static void BM_MakeUnmake(benchmark::State& state) {
+    std::vector<Board> boards = corpus();
+    const std::vector<std::list<Move>>& moves = corpusMoves();
+    int64_t count = 0;
+    for(auto _ : state) {
+        for(size_t i = 0; i < boards.size(); i++) {
+            for(const Move& m : moves[i]) {
+                boards[i].forwardMove(m);
+                boards[i].reverseMove(m);
+            }
+            count += moves[i].size();
+        }
+    }
+    state.SetItemsProcessed(count);
+}
+BENCHMARK(BM_MakeUnmake);
+
+static void BM_Evaluate(benchmark::State& state) {
+    const std::vector<Board>& boards = corpus();
+    for(auto _ : state) {
+        for(const Board& b : boards) {
+            benchmark::DoNotOptimize(evaluate(b));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_Evaluate);
+
+// Full Zobrist key computation, as done when a position is set up
+static void BM_HashFromScratch(benchmark::State& state) {
+    const std::vector<Board>& boards = corpus();
+    for(auto _ : state) {
+        for(const Board& b : boards) {
+            benchmark::DoNotOptimize(b.computeKey());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_HashFromScratch);
+
+// Incremental key update with nothing else to do: the null move only changes side and en passant keys
+static void BM_HashNullMove(benchmark::State& state) {
+    std::vector<Board> boards = corpus();
+    for(auto _ : state) {
+        for(Board& b : boards) {
+            b.forwardNullMove();
+            benchmark::DoNotOptimize(b.getKey());
+            b.reverseNullMove();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_HashNullMove);
+
+// Board to and from the 32-byte training data position
+static void BM_PackPosition(benchmark::State& state) {
+    const std::vector<Board>& boards = corpus();
+    PackedPosition packed;
+    for(auto _ : state) {
+        for(const Board& b : boards) {
+            b.pack(packed);
+            benchmark::DoNotOptimize(packed.occupancy);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+}
+BENCHMARK(BM_PackPosition);
+
+static void BM_UnpackPosition(benchmark::State& state) {
+    const std::vector<Board>& boards = corpus();
+    std::vector<PackedPosition> packed(boards.size());
+    for(size_t i = 0; i < boards.size(); i++) {
+        boards[i].pack(packed[i]);
+    }
+    Board b;
+    for(auto _ : state) {
+        for(const PackedPosition& p : packed) {
+            b.unpack(p);
+            benchmark::DoNotOptimize(b.getKey());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * packed.size());
+}
+BENCHMARK(BM_UnpackPosition);
+
+// Scratch file in the working directory, deleted on exit
+struct ScratchFile {
+    ScratchFile(const std::string& p) : path(p) {}
+    ~ScratchFile() { std::remove(path.c_str()); }
+    std::string path;
+};
+
+// A training file of a million records, written once for the reading benchmarks
+static const char* trainingFile() {
+    static ScratchFile file("chess_bench_read.bin");
+    static bool written = false;
+    if(!written) {
+        written = true;
+        const std::vector<Board>& boards = corpus();
+        TrainingWriter writer;
+        writer.open(file.path);
+        for(int i = 0; i < 1000000; i++) {
+            writer.write(makeRecord(boards[i % boards.size()], i % 600 - 300, Move(), i % 3 - 1));
+        }
+        writer.close();
+    }
+    return file.path.c_str();
+}
+
+// Buffered writing, in records per second
+static void BM_WriteRecords(benchmark::State& state) {
+    const std::vector<Board>& boards = corpus();
+    std::vector<TrainingRecord> records;
+    for(const Board& b : boards) {
+        records.push_back(makeRecord(b, 0, Move(), 0));
+    }
+    ScratchFile file("chess_bench_write.bin");
+    TrainingWriter writer;
+    writer.open(file.path);
+    for(auto _ : state) {
+        for(const TrainingRecord& r : records) {
+            writer.write(r);
+        }
+    }
+    writer.close();
+    state.SetItemsProcessed(state.iterations() * records.size());
+}
+BENCHMARK(BM_WriteRecords);
+
+// Walking the mapped records in place across range(0) threads, in records per second
+static void BM_ReadRecords(benchmark::State& state) {
+    TrainingReader reader;
+    reader.open(trainingFile());
+    for(auto _ : state) {
+        std::atomic<int64_t> total(0);
+        reader.parallelForEach(state.range(0), [&](int, const TrainingRecord* first, const TrainingRecord* last) {
+            int64_t sum = 0;
+            for(const TrainingRecord* r = first; r != last; r++) {
+                sum += r->score + r->result;
+            }
+            total += sum;
+        });
+        benchmark::DoNotOptimize(total.load());
+    }
+    state.SetItemsProcessed(state.iterations() * reader.size());
+}
+BENCHMARK(BM_ReadRecords)->Arg(1)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
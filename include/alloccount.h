@@ -0,0 +1,15 @@
+/*
+ *  Header information for the allocation counter, a test hook which checks that the search never touches
+ * the heap. Counting is compiled in only when CHESS_ALLOC_COUNT is defined (cmake -DCHESS_ALLOC_COUNT=ON),
+ * which replaces the global operator new. Normal builds keep the standard allocator.
+ */
+
+#ifndef __alloccount_h
+#define __alloccount_h
+
+#include <cstdint>
+
+// Heap allocations made so far by the calling thread. Always 0 when counting isn't compiled in.
+uint64_t threadAllocations();
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ *  Header information for the built-in search benchmark. Searches a fixed set of positions to a fixed depth
+ * and reports the node count and speed, so a change to the search can be checked against a known signature.
+ */
+
+#ifndef __bench_h
+#define __bench_h
+
+#include <cstdint>
+
+const int BENCH_DEFAULT_DEPTH = 7;
+
+// Searches every bench position and prints per-position and total node counts. Returns the total nodes,
+// which with one thread is identical between runs and builds of the same search.
+uint64_t runBench(int depth, int threads, int hashMb);
+
+#endif
@@ -5,62 +5,180 @@
 #ifndef __board_h
 #define __board_h
 
+#include <cstdint>
 #include <list>
 #include <string>
+#include <vector>
 #include "piece.h"
 
 typedef uint64_t Bitboard;
 
+// Standard starting position, used by the default constructor
+const std::string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Castling rights are kept as bit flags so they can be saved and restored in a single byte
+const unsigned char WHITE_KINGSIDE = 1;
+const unsigned char WHITE_QUEENSIDE = 2;
+const unsigned char BLACK_KINGSIDE = 4;
+const unsigned char BLACK_QUEENSIDE = 8;
+
+// Everything forwardMove overwrites, stored so reverseMove can put the board back exactly
+struct Undo {
+    Move move;
+    Piece captured;
+    unsigned char castleRights;
+    int epColumn;
+    int halfmoveClock;
+    uint64_t key;
+};
+
+// Enough for the moves of any position, pseudo-legal ones included
+const int MAX_MOVES = 256;
+
+// Fixed-capacity move list, so generating moves never touches the heap. Constructing one initializes
+// every entry, so the search keeps its lists in ThreadData rather than building them at each node.
+struct MoveList {
+    MoveList() : count(0) {}
+
+    void push_back(const Move& m) { moves[count++] = m; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    Move& operator[](int i) { return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    Move moves[MAX_MOVES];
+    int count;
+};
+
+// 32-byte position used by training data, defined in training.h
+struct PackedPosition;
+
 // START OF BOARD CLASS
 
 class Board {
     public:
     Board();
+    Board(const std::string& fen);
+
+    // Position setup and export in Forsyth-Edwards Notation
+    bool setFen(const std::string& fen);
+    std::string getFen() const;
+    // Compact binary form for training data. pack keeps at most 32 pieces.
+    void pack(PackedPosition& packed) const;
+    bool unpack(const PackedPosition& packed);
+
+    // Board-level functions for pieces. Adds the piece's pseudo-legal moves to moves.
+    void generateMoves(const Piece* p, MoveList& moves);
+    // Fills moves with every legal move for the side to move
+    void generateLegalMoves(std::list<Move>& moves);
+    // Staged generation for the side to move, one category at a time. Moves are pseudo-legal, so check
+    // causesCheck before playing them.
+    // Captures (en passant included) and all promotions
+    void generateCaptures(MoveList& moves);
+    // Everything else, castling included
+    void generateQuiets(MoveList& moves);
+    // Only for a side in check: king moves, and captures or blocks of a single checker
+    void generateEvasions(MoveList& moves);
+    // Quiet moves which give check
+    void generateQuietChecks(MoveList& moves);
+    bool isPseudoLegal(const Move& m) const;
+
+    // Recomputes whiteAttack and blackAttack from scratch for both colors
+    void updateAttacks();
+    Bitboard getAttacks(bool isWhite) const { return (isWhite) ? whiteAttack : blackAttack; }
 
-    // Board-level functions for pieces
-    void generateMoves(Piece* p);
-    
     // Checks for special moves and conditions
+    bool isCapture(const Move& m) const;
+    bool isAttacked(unsigned int r, unsigned int c, bool byWhite) const;
 
     // Checks for special board conditions
-    bool isCheck(bool isWhite);
+    bool isCheck(bool isWhite) const;
     bool causesCheck(const Move& m);
     bool isStalemate(bool isWhite);
 
     // Funtional methods to facilitate move and updating the board
     bool validMove(const Square& loc1, const Square& loc2);
     bool move(const Square& loc1, const Square& loc2);
+    // Brings the attack maps up to date, once per position
     void updateBoard();
 
-    private:
-    // Helper functions which need access to boardPieces
-    void trimCheck();
-    void addCastle(bool isWhite);
-    void generateMovesPawn(unsigned int r, unsigned int c, Piece* p);
-    void generateMovesKnight(unsigned int r, unsigned int c, Piece* p);
-    void generateMovesBishop(unsigned int r, unsigned int c, Piece* p);
-    void generateMovesRook(unsigned int r, unsigned int c, Piece* p);
-    void generateMovesQueen(unsigned int r, unsigned int c, Piece* p);
-    void generateMovesKing(unsigned int r, unsigned int c, Piece* p);
+    // Performs and undoes moves while looking ahead. Moves must be undone in reverse order.
     void forwardMove(const Move& m);
     void reverseMove(const Move& m);
+    // Passes the turn without moving, for null move pruning
+    void forwardNullMove();
+    void reverseNullMove();
+    // Makes room for plies more moves, so looking ahead that far never grows the undo history
+    void reserveHistory(size_t plies) { moveHistory.reserve(moveHistory.size() + plies); }
+
+    // Read-only access for evaluation and front ends
+    const Piece& getPiece(unsigned int r, unsigned int c) const { return boardPieces[r][c]; }
+    bool isWhiteToMove() const { return whiteToMove; }
+    int getHalfmoveClock() const { return halfmoveClock; }
+    unsigned char getCastleRights() const { return castleRights; }
+    int getEpColumn() const { return epColumn; }
+    uint64_t getKey() const { return key; }
+    uint64_t computeKey() const;
+    bool isRepetition() const;
+    bool hasNonPawnMaterial(bool isWhite) const;
+    int getPly() const { return 2 * (fullmoveNumber - 1) + (whiteToMove ? 0 : 1); }
+
+    private:
+    // Helper functions which need access to boardPieces
+    void clear();
+    bool placePiece(char type, bool isWhite, unsigned int r, unsigned int c);
+    bool canCastle(bool isWhite, bool kingside) const;
+    void addCastle(bool isWhite, MoveList& moves);
+    bool attacksSquare(unsigned int r, unsigned int c, unsigned int tr, unsigned int tc) const;
+    void generateStaged(MoveList& moves, bool captures, bool quiets, Bitboard targets, bool castle);
+    void generateMovesPawn(unsigned int r, unsigned int c, const Piece* p, MoveList& moves);
+    void generateMovesKnight(unsigned int r, unsigned int c, const Piece* p, MoveList& moves);
+    void generateMovesBishop(unsigned int r, unsigned int c, const Piece* p, MoveList& moves);
+    void generateMovesRook(unsigned int r, unsigned int c, const Piece* p, MoveList& moves);
+    void generateMovesQueen(unsigned int r, unsigned int c, const Piece* p, MoveList& moves);
+    void generateMovesKing(unsigned int r, unsigned int c, const Piece* p, MoveList& moves);
 
     Piece boardPieces[8][8];
-    // Pointers and maps which keep immediate reference to important pieces
-    // Lists used for rapid erase and insert
-    std::list<Piece> whitePieces;
-    std::list<Piece> blackPieces;
 
     Bitboard whiteAttack;
     Bitboard blackAttack;
-    
-    // NOTE: If no piece was captured last move, this is NULL. It holds whatever was in the square a piece was moved to
-    Piece* lastCapturedPiece;
 
-    King* whiteKing;
-    King* blackKing;
+    // One entry per move made with forwardMove, popped by reverseMove
+    std::vector<Undo> moveHistory;
+
+    // King locations are tracked directly so check detection doesn't need to search the board
+    Square whiteKing;
+    Square blackKing;
+
+    // Game state which isn't visible from the pieces alone
+    bool whiteToMove;
+    unsigned char castleRights;
+    // Column of a pawn which just moved two squares, -1 if en passant isn't possible
+    int epColumn;
+    int halfmoveClock;
+    int fullmoveNumber;
+    // Zobrist hash of the position, updated incrementally by forwardMove
+    uint64_t key;
+
     // Avoids redundancy wih updating board and pieces. Makes sure it's done only once between positions
     bool isUpdated;
 };
 
-#endif
\ No newline at end of file
+// USEFUL FUNCTIONS
+inline bool isPromotion(const Move& m) {
+    char type = std::get<2>(m);
+    return type == 'q' || type == 'r' || type == 'b' || type == 'n';
+}
+inline bool isNullMove(const Move& m) { return std::get<2>(m) == '\0'; }
+
+// Converts between moves and coordinate notation (e2e4, e7e8q)
+std::string moveToString(const Move& m);
+std::string squareToString(const Square& s);
+Move parseMove(Board& board, const std::string& str);
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ *  Evaluation weights in centipawns, written by the tune tool (tools/tune). Regenerate them from data
+ * rather than editing by hand. Piece-square tables are from white's point of view with row 0 being the
+ * eighth rank; black pieces read them mirrored vertically.
+ *
+ *  Not tuned yet: these are the original hand-picked values
+ */
+
+#ifndef __eval_weights_h
+#define __eval_weights_h
+
+// Indexed by piece: pawn, knight, bishop, rook, queen, king
+const int materialWeights[6] = {100, 300, 300, 500, 900, 0};
+
+const int pieceSquareWeights[6][8][8] = {
+    // Pawn
+    {
+        {   0,   0,   0,   0,   0,   0,   0,   0},
+        {  50,  50,  50,  50,  50,  50,  50,  50},
+        {  10,  10,  20,  30,  30,  20,  10,  10},
+        {   5,   5,  10,  25,  25,  10,   5,   5},
+        {   0,   0,   0,  20,  20,   0,   0,   0},
+        {   5,  -5, -10,   0,   0, -10,  -5,   5},
+        {   5,  10,  10, -20, -20,  10,  10,   5},
+        {   0,   0,   0,   0,   0,   0,   0,   0}
+    },
+    // Knight
+    {
+        { -50, -40, -30, -30, -30, -30, -40, -50},
+        { -40, -20,   0,   0,   0,   0, -20, -40},
+        { -30,   0,  10,  15,  15,  10,   0, -30},
+        { -30,   5,  15,  20,  20,  15,   5, -30},
+        { -30,   0,  15,  20,  20,  15,   0, -30},
+        { -30,   5,  10,  15,  15,  10,   5, -30},
+        { -40, -20,   0,   5,   5,   0, -20, -40},
+        { -50, -40, -30, -30, -30, -30, -40, -50}
+    },
+    // Bishop
+    {
+        { -20, -10, -10, -10, -10, -10, -10, -20},
+        { -10,   0,   0,   0,   0,   0,   0, -10},
+        { -10,   0,   5,  10,  10,   5,   0, -10},
+        { -10,   5,   5,  10,  10,   5,   5, -10},
+        { -10,   0,  10,  10,  10,  10,   0, -10},
+        { -10,  10,  10,  10,  10,  10,  10, -10},
+        { -10,   5,   0,   0,   0,   0,   5, -10},
+        { -20, -10, -10, -10, -10, -10, -10, -20}
+    },
+    // Rook
+    {
+        {   0,   0,   0,   0,   0,   0,   0,   0},
+        {   5,  10,  10,  10,  10,  10,  10,   5},
+        {  -5,   0,   0,   0,   0,   0,   0,  -5},
+        {  -5,   0,   0,   0,   0,   0,   0,  -5},
+        {  -5,   0,   0,   0,   0,   0,   0,  -5},
+        {  -5,   0,   0,   0,   0,   0,   0,  -5},
+        {  -5,   0,   0,   0,   0,   0,   0,  -5},
+        {   0,   0,   0,   5,   5,   0,   0,   0}
+    },
+    // Queen
+    {
+        { -20, -10, -10,  -5,  -5, -10, -10, -20},
+        { -10,   0,   0,   0,   0,   0,   0, -10},
+        { -10,   0,   5,   5,   5,   5,   0, -10},
+        {  -5,   0,   5,   5,   5,   5,   0,  -5},
+        {   0,   0,   5,   5,   5,   5,   0,  -5},
+        { -10,   5,   5,   5,   5,   5,   0, -10},
+        { -10,   0,   5,   0,   0,   0,   0, -10},
+        { -20, -10, -10,  -5,  -5, -10, -10, -20}
+    },
+    // King
+    {
+        { -30, -40, -40, -50, -50, -40, -40, -30},
+        { -30, -40, -40, -50, -50, -40, -40, -30},
+        { -30, -40, -40, -50, -50, -40, -40, -30},
+        { -30, -40, -40, -50, -50, -40, -40, -30},
+        { -20, -30, -30, -40, -40, -30, -30, -20},
+        { -10, -20, -20, -20, -20, -20, -20, -10},
+        {  20,  20,   0,   0,   0,   0,  20,  20},
+        {  20,  30,  10,   0,   0,  10,  30,  20}
+    }
+};
+
+#endif
@@ -0,0 +1,18 @@
+/*
+ *  Header information for static evaluation. Scores a board from the point of view of the side to move.
+ */
+
+#ifndef __evaluate_h
+#define __evaluate_h
+
+#include "board.h"
+
+// Scores are in centipawns. A forced mate is reported as MATE minus the distance to it in plies.
+const int MATE = 32000;
+const int INFINITE_SCORE = 32001;
+
+int evaluate(const Board& board);
+// Index of a piece type ('p' through 'k') in the weight tables of eval_weights.h
+int pieceIndex(char type);
+
+#endif
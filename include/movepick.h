@@ -0,0 +1,51 @@
+/*
+ *  Header information for the move picker. Hands the search its moves one at a time, best first, and
+ * only generates each category of moves once the ones before it have run out.
+ */
+
+#ifndef __movepick_h
+#define __movepick_h
+
+#include "board.h"
+
+class MovePicker {
+    public:
+    // Main search: the hash move, then captures and promotions, then the killers, then quiet moves by
+    // history, or every evasion when in check. moves is the node's list from the ply stack, killers
+    // holds two quiet moves which cut off at this ply, and history is the side to move's table, indexed
+    // by from and to square.
+    MovePicker(Board& board, MoveList& moves, const Move& ttMove, const Move* killers, const int (*history)[64], bool inCheck);
+    // Quiescence search: captures and queen promotions, or every evasion when in check
+    MovePicker(Board& board, MoveList& moves, bool inCheck);
+
+    // Returns the next pseudo-legal move, or a null move once there are none left
+    Move next();
+
+    private:
+    enum Stage {
+        STAGE_TT_MOVE, STAGE_CAPTURES_INIT, STAGE_CAPTURES, STAGE_KILLERS, STAGE_QUIETS_INIT, STAGE_QUIETS,
+        STAGE_EVASIONS_INIT, STAGE_EVASIONS, STAGE_DONE
+    };
+
+    int score(const Move& m) const;
+    // Scores the generated moves, leaving out the hash move which was already returned, and the killers
+    // too if skipKillers is set
+    void load(bool skipKillers);
+    // Takes the best remaining move. Moves with equal scores come out in generation order.
+    bool pick(Move& m);
+
+    Board& board;
+    MoveList& moves;
+    Move ttMove;
+    const Move* killers;
+    const int (*history)[64];
+    Stage stage;
+    bool inCheck;
+    bool quiescence;
+    // Moves before current were already returned
+    int current;
+    int killerIndex;
+    int scores[MAX_MOVES];
+};
+
+#endif
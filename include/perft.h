@@ -0,0 +1,25 @@
+/*
+ *  Header information for perft, which counts the leaves of the legal move tree. Checked against
+ * published counts, it validates move generation, and it cross-checks the staged generators against it.
+ */
+
+#ifndef __perft_h
+#define __perft_h
+
+#include <cstdint>
+#include <ostream>
+#include "board.h"
+
+// Number of legal move sequences of exactly depth plies from the board's position
+uint64_t perft(Board& board, int depth);
+
+// Prints the perft count below each root move, then the total, which is returned
+uint64_t perftDivide(Board& board, int depth, std::ostream& out);
+
+// Runs perft on reference positions with known counts. At every interior node it also checks that the
+// staged generators produce exactly the legal moves once filtered, that generateQuietChecks produces
+// exactly the legal quiet checks, and that isPseudoLegal accepts exactly the moves the piece generators
+// produce. Returns false if anything disagrees.
+bool runPerftSuite(std::ostream& out);
+
+#endif
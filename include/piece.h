@@ -7,24 +7,25 @@
 #define __piece_h
 
 #include <string>
-#include <list>
 #include <tuple>
 
 typedef std::pair<unsigned int, unsigned int> Square;
 // Updated as of 9/11/23 to use tuple instead of pair, thus storing STARTING LOCATION, ENDING LOCATION, MOVE TYPE
 typedef std::tuple<Square,Square,char> Move;
+// Moves stored in pair of location (Square) and a character signaling some specific move types
+// Codes: N = Normal, X = Capture, E = En Passant, C = Castle (May add + for checks but unsure)
+// Promotions use the lowercase letter of the piece promoted to (q, r, b, n) and may also capture
 
 // Parent struct for all piece types.
 struct Piece {
-  Piece() : pieceType(' ') {}
+  Piece() : pieceType(' '), pieceValue(0), isWhite(false) {}
 
   char getPieceType() const { return pieceType; }
   bool isPieceWhite() const { return isWhite; }
   int getPieceValue() const { return pieceValue; }
   const Square &getLocation() const { return location; }
-  const std::list<Move> &getMoves() const { return moveList; }
 
-  bool isNull() { return pieceType == ' '; }
+  bool isNull() const { return pieceType == ' '; }
 
   // Pawns and Kings require extra information of if they have been moved and
   // their last location. As such, this function is virtual as these said
@@ -34,10 +35,6 @@ struct Piece {
     location.second = c;
   }
 
-  // Generates moves for this piece, stored in moveList. Said list can be easily
-  // retrieved by a separate function.
-  virtual bool setMoves(std::list<Move> &moveList);
-
   // For sets which store pieces
   bool operator<(const Piece& other) { return pieceType < other.pieceType; }
 
@@ -46,11 +43,7 @@ struct Piece {
   bool isWhite;
 
   // Locations stored in pair of row,column
-  // Moves stored in pair of location (Square) and a character signaling some specific move types
-  // Codes: N = Normal, X = Capture, E = En Passant, C = Castle (May add + for checks but unsure)
   Square location;
-  // Lists used for rapid erase and insert
-  std::list<Move> moveList;
 };
 
 struct Pawn : public Piece {
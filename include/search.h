@@ -0,0 +1,198 @@
+/*
+ *  Header information for the search. Runs iterative deepening alpha-beta on its own threads so the
+ * front end can keep reading commands (stop, quit) while the engine thinks.
+ */
+
+#ifndef __search_h
+#define __search_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "evaluate.h"
+#include "stats.h"
+#include "timeman.h"
+#include "tt.h"
+
+const int MAX_PLY = 128;
+// Scores beyond this are mates found within the search tree
+const int MATE_BOUND = MATE - MAX_PLY;
+
+class Search;
+
+// Limits for a single search, as given by the UCI go command. Times are in milliseconds, movetime -1 when
+// not given. A clock can be negative when the GUI allows a time margin, so whether one was given is kept
+// separately.
+struct SearchLimits {
+    SearchLimits()
+        : wtime(0), btime(0), hasWtime(false), hasBtime(false), winc(0), binc(0), movestogo(0), movetime(-1),
+          depth(0), nodes(0), infinite(false), ponder(false) {}
+
+    int64_t wtime;
+    int64_t btime;
+    bool hasWtime;
+    bool hasBtime;
+    int64_t winc;
+    int64_t binc;
+    int movestogo;
+    int64_t movetime;
+    int depth;
+    uint64_t nodes;
+    bool infinite;
+    // Searching the expected reply on the opponent's time. Limits only apply after ponderhit.
+    bool ponder;
+    // Root moves to choose from. Empty allows them all.
+    std::vector<Move> searchMoves;
+};
+
+// A legal move at the root with what the search has learned about it. Scores are from the root side's
+// point of view. Only moves which were reported as a line get an exact score; the rest are upper bounds.
+struct RootMove {
+    RootMove(const Move& m) : move(m), score(-INFINITE_SCORE), nodes(0) {
+        pv.reserve(MAX_PLY);
+        scoreHistory.reserve(MAX_PLY);
+    }
+
+    Move move;
+    // Result of the latest search of this move
+    int score;
+    // Nodes spent below this move over the whole search
+    uint64_t nodes;
+    // Best line starting with this move, from the last iteration where it was reported
+    std::vector<Move> pv;
+    // score at the end of each completed iteration, starting with the thread's first depth
+    std::vector<int> scoreHistory;
+};
+
+// Everything a search thread writes while searching, allocated once when the thread is created so the
+// search itself never touches the heap. Aligned to a cache line so no two threads share one.
+struct alignas(64) ThreadData {
+    // Move list of the node at each ply, quiescence included. Move lists are too big to build on the
+    // stack at every node.
+    MoveList moves[MAX_PLY];
+
+    // Two quiet moves which caused beta cutoffs at each ply, most recent first
+    Move killers[MAX_PLY][2];
+
+    // Quiet moves which caused beta cutoffs, by side, from square and to square
+    int history[2][64][64];
+
+    // Triangular principal variation table. pvTable[ply] holds the best line found from ply onwards.
+    Move pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+};
+
+// One search thread. The main thread (id 0) runs the iterative deepening loop which reports to the GUI
+// and decides when to stop. Helpers search the same position alongside it and only share the
+// transposition table (lazy SMP), so their results reach the main thread through hash hits.
+class alignas(64) SearchThread {
+    public:
+    SearchThread(Search& search, int id);
+
+    void start(const Board& board);
+    void join();
+
+    void clearHistory();
+    // Halves the history so it keeps learning from earlier moves of the game without being dominated by them
+    void ageHistory();
+
+    uint64_t getNodes() const { return nodes.load(std::memory_order_relaxed); }
+    const SearchStats& getStats() const { return stats; }
+    void resetStats() { stats.reset(); }
+
+    private:
+    friend class Search;
+
+    void run();
+    void prepare();
+    void iterativeDeepening();
+    int alphaBeta(int alpha, int beta, int depth, int ply, bool allowNull);
+    RootMove* findRootMove(const Move& m);
+    int quiesce(int alpha, int beta, int ply);
+    void updateKillers(const Move& m, int ply);
+    void updateHistory(const Move& m, int depth);
+    Move findPonderMove();
+    bool checkStop();
+
+    Search& search;
+    int id;
+    std::thread thread;
+    Board board;
+    // Only this thread writes it. Atomic so the main thread can total nodes for reporting.
+    std::atomic<uint64_t> nodes;
+    SearchStats stats;
+    std::unique_ptr<ThreadData> data;
+    // Heap allocations made during the last search, counted when built with CHESS_ALLOC_COUNT
+    uint64_t allocations;
+
+    // Moves the root may play, restricted by searchmoves. Lines already found this iteration are kept in
+    // front, best first, and rootMoves[pvIndex] onwards are the moves still to be ranked.
+    std::vector<RootMove> rootMoves;
+    size_t pvIndex;
+
+    Move bestMove;
+    Move ponderMove;
+    int bestScore;
+};
+
+class Search {
+    public:
+    Search();
+    ~Search();
+
+    // Starts searching a copy of board and returns immediately
+    void start(const Board& board, const SearchLimits& limits);
+    // Asks a running search to finish and waits for it
+    void stop();
+    void wait();
+    // The opponent played the move we were pondering on. The search carries on under its time limits.
+    void ponderhit() { timeManager.ponderhit(); }
+
+    // Hash entries and history persist between searches of the same game. This clears them for a new one.
+    void newGame();
+    void setHashSize(size_t mb);
+    void setThreads(int count);
+    int getThreads() const { return threads.size(); }
+    // Number of best lines to find and report. More than one slows the search down.
+    void setMultiPV(int count) { stop(); multiPV = std::max(1, count); }
+    void setMoveOverhead(int ms) { timeManager.setMoveOverhead(ms); }
+    // Where info and bestmove lines are written. nullptr searches silently.
+    void setOutput(std::ostream* os) { out = os; }
+
+    // Results of the last search, valid after wait() returns
+    const Move& getBestMove() const { return threads[0]->bestMove; }
+    const Move& getPonderMove() const { return threads[0]->ponderMove; }
+    int getScore() const { return threads[0]->bestScore; }
+    // Every move the root considered, reported lines first in order
+    const std::vector<RootMove>& getRootMoves() const { return threads[0]->rootMoves; }
+    // Nodes searched by all threads
+    uint64_t getNodes() const;
+    // Heap allocations made by all threads during the last search. Only counted in builds with
+    // CHESS_ALLOC_COUNT, and 0 otherwise.
+    uint64_t getAllocations() const;
+
+    // Adds every thread's statistics counters into total. Safe to call while searching.
+    void collectStats(SearchStats& total) const;
+    void resetStats();
+
+    private:
+    friend class SearchThread;
+
+    void printInfo(int depth);
+
+    SearchLimits limits;
+    TimeManager timeManager;
+    TranspositionTable tt;
+    std::atomic<bool> stopFlag;
+    std::vector<std::unique_ptr<SearchThread>> threads;
+    int multiPV;
+    std::ostream* out;
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ *  Header information for search statistics. Counters are compiled in only when CHESS_STATS is defined
+ * (cmake -DCHESS_STATS=ON), so normal builds pay nothing for them.
+ */
+
+#ifndef __stats_h
+#define __stats_h
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// A counter written by a single thread. The relaxed load and store compile to a plain increment, unlike
+// fetch_add, while still letting other threads read the value during a search.
+struct StatCounter {
+    StatCounter() : value(0) {}
+
+    void inc(uint64_t n = 1) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    void reset() { value.store(0, std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> value;
+};
+
+// Beta cutoffs are bucketed by the index of the move which caused them. The last bucket holds the rest.
+const int CUTOFF_BUCKETS = 8;
+
+// Counters for one search thread. Each thread owns one and the front end adds them up on demand.
+struct SearchStats {
+    void reset();
+    // Adds other's counters into this one
+    void add(const SearchStats& other);
+    std::string toJson(int threads) const;
+
+    StatCounter nodes;
+    StatCounter qnodes;
+    StatCounter ttProbes;
+    StatCounter ttHits;
+    StatCounter ttCutoffs;
+    StatCounter betaCutoffs;
+    StatCounter cutoffIndex[CUTOFF_BUCKETS];
+    StatCounter nullMoveTries;
+    StatCounter nullMoveCutoffs;
+    // An LMR search succeeds when the reduced search fails low and no full depth re-search is needed
+    StatCounter lmrTries;
+    StatCounter lmrResearches;
+    // Board::generateMoves calls by piece type, in the order p n b r q k
+    StatCounter movegen[6];
+};
+
+// Counters of the search running on this thread, or nullptr outside of a search
+extern thread_local SearchStats* threadStats;
+
+#ifdef CHESS_STATS
+#define STAT_INC(counter) do { if(threadStats) threadStats->counter.inc(); } while(0)
+#else
+#define STAT_INC(counter) do {} while(0)
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ *  Header information for time management. Turns the clock state given by the GUI into soft and hard
+ * time limits for a search, and adjusts them as the search learns how settled the position is.
+ */
+
+#ifndef __timeman_h
+#define __timeman_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Defined in search.h
+struct SearchLimits;
+
+class TimeManager {
+    public:
+    TimeManager();
+
+    // Starts the clock and works out the limits for the side to move. ply is the game ply, used to
+    // guess how many moves are left when the time control doesn't say.
+    void init(const SearchLimits& limits, bool isWhite, int ply);
+
+    // Called after each completed iteration of the search, with whether the best move differs from the
+    // last iteration's. Rescales the soft limit from best move stability and score drop, and returns true
+    // if another iteration shouldn't be started.
+    bool iterationDone(bool bestMoveChanged, int score);
+
+    // Called at every node. Only reads the clock once every CHECK_INTERVAL nodes, so most calls
+    // are a single comparison. Returns true once the hard limit has passed.
+    bool outOfTime(uint64_t nodes) {
+        if(nodes < nextCheck) {
+            return hardStop;
+        }
+        nextCheck = nodes + CHECK_INTERVAL;
+        hardStop = timeControlled && !pondering && elapsed() >= hardLimit;
+        return hardStop;
+    }
+
+    // The opponent played the expected move. Our clock starts now and the limits take effect.
+    // Safe to call from another thread while the search is running.
+    void ponderhit();
+    bool isPondering() const { return pondering; }
+
+    // Time on our clock, which restarts at ponderhit. Limits are measured against this.
+    int64_t elapsed() const;
+    // Time since the search started, pondering included. Used for reporting time and speed.
+    int64_t searchElapsed() const;
+    int64_t getSoftLimit() const { return softLimit; }
+    int64_t getHardLimit() const { return hardLimit; }
+
+    // Time reserved per move for GUI and operating system lag
+    void setMoveOverhead(int ms) { moveOverhead = ms; }
+
+    // Roughly a millisecond of search at current speeds
+    static const uint64_t CHECK_INTERVAL = 1024;
+
+    private:
+    static int64_t now();
+
+    // Milliseconds on the steady clock. Atomic because ponderhit restarts it from the front end thread.
+    std::atomic<int64_t> startTime;
+    // When init was called. Unlike startTime, ponderhit leaves it alone.
+    int64_t searchStartTime;
+    std::atomic<bool> pondering;
+    bool timeControlled;
+    int moveOverhead;
+
+    // optimumTime is the unscaled budget; softLimit is it after stability and score adjustments
+    int64_t optimumTime;
+    int64_t softLimit;
+    int64_t hardLimit;
+
+    // Search history used to scale the soft limit
+    int stability;
+    int lastScore;
+    bool hasScore;
+
+    uint64_t nextCheck;
+    bool hardStop;
+};
+
+#endif
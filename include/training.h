@@ -0,0 +1,123 @@
+/*
+ *  Header information for training data. Evaluated positions are stored as fixed-size binary records:
+ * written through a buffered stream and read back by mapping the file into memory, so a reader walks
+ * the records in place without parsing or copying them.
+ */
+
+#ifndef __training_h
+#define __training_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+
+// A position in 32 bytes. Occupancy has bit r*8+c set for each occupied square (the Bitboard layout,
+// row 0 is rank 8). pieces holds one nibble per occupied square in the same order, low nibble first:
+// 1-6 for pawn, knight, bishop, rook, queen, king, plus 8 for black.
+struct PackedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t sideToMove;
+    uint8_t castleRights;
+    int8_t epColumn;
+    uint8_t halfmoveClock;
+    uint16_t fullmoveNumber;
+    uint16_t reserved;
+};
+
+// One evaluated position. Records are written in the machine's byte order (little endian on every
+// platform we build for).
+struct TrainingRecord {
+    PackedPosition position;
+    // Search score in centipawns from the side to move's point of view
+    int16_t score;
+    // Best move, see packMove
+    uint16_t move;
+    // Game ply the position was reached at
+    uint16_t ply;
+    // Game result from white's point of view: 1 win, 0 draw, -1 loss
+    int8_t result;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+static_assert(sizeof(TrainingRecord) == 40, "TrainingRecord must stay 40 bytes");
+
+// Moves in 16 bits: from square (6), to square (6) and the move code (3). A null move packs to 0.
+uint16_t packMove(const Move& m);
+Move unpackMove(uint16_t packed);
+
+// Fills in a record for board. result can be filled in later, once the game is over.
+TrainingRecord makeRecord(const Board& board, int score, const Move& best, int result);
+
+// Appends records to a file, buffering them so the disk sees large writes
+class TrainingWriter {
+    public:
+    TrainingWriter() : file(nullptr), written(0) {}
+    ~TrainingWriter() { close(); }
+
+    // Opens a file for writing, appending to it if append is set. A new file starts with a header.
+    bool open(const std::string& path, bool append = false);
+    void write(const TrainingRecord& record);
+    void flush();
+    void close();
+    uint64_t getWritten() const { return written; }
+
+    private:
+    static const size_t BUFFER_RECORDS = 65536;
+
+    FILE* file;
+    std::vector<TrainingRecord> buffer;
+    uint64_t written;
+};
+
+// Maps a training file into memory and gives access to its records in place. Records stay valid
+// until the reader is closed or destroyed.
+class TrainingReader {
+    public:
+    TrainingReader() : data(nullptr), mappedSize(0), records(nullptr), count(0) {}
+    ~TrainingReader() { close(); }
+    TrainingReader(const TrainingReader&) = delete;
+    TrainingReader& operator=(const TrainingReader&) = delete;
+
+    // Returns false if the file is missing or isn't a training file of this version
+    bool open(const std::string& path);
+    void close();
+
+    size_t size() const { return count; }
+    const TrainingRecord& operator[](size_t i) const { return records[i]; }
+    const TrainingRecord* begin() const { return records; }
+    const TrainingRecord* end() const { return records + count; }
+
+    // The index-th of shards contiguous, near equal slices of the records
+    void shard(int index, int shards, const TrainingRecord*& first, const TrainingRecord*& last) const;
+
+    // Calls fn(index, first, last) for each shard on its own thread and waits for them all
+    template<class Function>
+    void parallelForEach(int threads, Function fn) const {
+        std::vector<std::thread> workers;
+        for(int i = 0; i < threads; i++) {
+            const TrainingRecord* first;
+            const TrainingRecord* last;
+            shard(i, threads, first, last);
+            workers.push_back(std::thread(fn, i, first, last));
+        }
+        for(std::thread& t : workers) {
+            t.join();
+        }
+    }
+
+    private:
+    // Start and length of the mapping (or of the copy where mmap isn't available)
+    void* data;
+    size_t mappedSize;
+    const TrainingRecord* records;
+    size_t count;
+    std::vector<char> fallback;
+};
+
+#endif
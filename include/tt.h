@@ -0,0 +1,63 @@
+/*
+ *  Header information for the transposition table. Caches search results by Zobrist key so positions
+ * reached by different move orders, or searched on a previous move, don't have to be searched again.
+ */
+
+#ifndef __tt_h
+#define __tt_h
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include "piece.h"
+
+// What a stored score says about the true score of the position
+const uint8_t BOUND_NONE = 0;
+const uint8_t BOUND_UPPER = 1;
+const uint8_t BOUND_LOWER = 2;
+const uint8_t BOUND_EXACT = 3;
+
+// A probed entry, unpacked from its slot in the table
+struct TTEntry {
+    uint64_t key;
+    Move move;
+    int16_t score;
+    int8_t depth;
+    uint8_t bound;
+    // Search the entry was written in. Entries from older searches are replaced first.
+    uint8_t generation;
+};
+
+class TranspositionTable {
+    public:
+    TranspositionTable();
+
+    // Reallocates the table to the given size in megabytes, discarding its contents
+    void resize(size_t mb);
+    void clear();
+    // Called at the start of every search. Entries are aged rather than cleared so results from
+    // the previous move (or from pondering) carry over.
+    void newSearch() { generation++; }
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, const Move& move, int score, int depth, uint8_t bound);
+
+    // Permille of sampled entries written during the current search, for UCI "hashfull"
+    int hashfull() const;
+
+    private:
+    // The table is shared by all search threads without locks. Each slot keeps the entry packed into one
+    // word and the key XORed with that word, so an entry torn by two threads writing at once no longer
+    // matches its key and is ignored. Relaxed atomics compile to plain loads and stores.
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Slot[]> table;
+    size_t size;
+    uint8_t generation;
+};
+
+#endif
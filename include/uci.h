@@ -0,0 +1,13 @@
+/*
+ *  Header information for the Universal Chess Interface front end, used by chess GUIs and tournament managers.
+ */
+
+#ifndef __uci_h
+#define __uci_h
+
+// Reads UCI commands from standard input until "quit". Any command line arguments are instead run as
+// one command ("bench" or "perft") and the function returns when it finishes. Returns the process exit
+// status, which is nonzero only when a command line "perft" check fails.
+int uciLoop(int argc, char* argv[]);
+
+#endif
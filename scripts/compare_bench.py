@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Compares two chess_bench result files and flags regressions.
+
+Produce the inputs with:
+    chess_bench --benchmark_out=<file>.json --benchmark_out_format=json [--benchmark_repetitions=N]
+
+Usage:
+    compare_bench.py baseline.json current.json [--threshold 0.05]
+
+With repetitions the median of each benchmark is compared. Exits with status 1 if any benchmark's
+time got worse by more than the threshold (a fraction, 0.05 = 5%). That is CPU time, except for
+benchmarks registered with UseRealTime (named .../real_time), where it is wall time: they run work on
+other threads, and the CPU time of the timing thread only covers waiting for them.
+"""
+
+import argparse
+import json
+import sys
+
+UNIT_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+    """Returns {benchmark name: time in ns}, preferring median aggregates when present."""
+    with open(path) as f:
+        data = json.load(f)
+    plain, medians = {}, {}
+    for b in data.get("benchmarks", []):
+        field = "real_time" if "/real_time" in b["name"] else "cpu_time"
+        time = b[field] * UNIT_NS[b.get("time_unit", "ns")]
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[b["run_name"]] = time
+        else:
+            plain.setdefault(b.get("run_name", b["name"]), time)
+    plain.update(medians)
+    return plain
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flag chess_bench regressions between two runs")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="relative slowdown that counts as a regression (default 0.05)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+    print(f"{'benchmark':40} {'baseline':>12} {'current':>12} {'change':>8}")
+    for name in sorted(baseline.keys() & current.keys()):
+        change = current[name] / baseline[name] - 1.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  improved"
+        print(f"{name:40} {baseline[name]:12.0f} {current[name]:12.0f} {change:+8.1%}{flag}")
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:40} missing from current run")
+
+    if regressions:
+        print(f"{regressions} regression(s) beyond {args.threshold:.0%}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,78 @@
+/*
+ *  CPP Implementation for the allocation counter
+ */
+
+#include "alloccount.h"
+
+#ifdef CHESS_ALLOC_COUNT
+
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t allocationCount = 0;
+
+uint64_t threadAllocations() {
+    return allocationCount;
+}
+
+static void* countedAlloc(std::size_t size) {
+    allocationCount++;
+    return std::malloc(size ? size : 1);
+}
+
+static void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    allocationCount++;
+    // aligned_alloc wants the size rounded up to a multiple of the alignment
+    std::size_t a = static_cast<std::size_t>(align);
+    return std::aligned_alloc(a, (size + a - 1) / a * a);
+}
+
+void* operator new(std::size_t size) {
+    void* p = countedAlloc(size);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    void* p = countedAlignedAlloc(size, align);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+// Both allocators above hand out memory which free() releases
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#else
+
+uint64_t threadAllocations() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ *  CPP Implementation for the built-in search benchmark
+ */
+
+#include "bench.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "board.h"
+#include "search.h"
+
+// The perft test positions followed by middlegames and endgames from real games
+static const char* BENCH_FENS[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkb1r/ppp1ppp1/2n2n2/3p3p/3P4/P1N1PN2/1PP2PPP/R1BQKB1R w KQkq - 0 6",
+    "1r1k3r/p1p2p1p/2pb4/P7/2P1B3/8/7P/RK6 w - - 0 29",
+    "r7/1k6/8/8/1K3b2/8/8/2r5 w - - 0 83",
+    "8/5R1p/5P2/1p2k1p1/p7/8/2Pr1PK1/8 w - - 2 43",
+    "r1b1k2r/1p4pp/2p2p2/p1QpN3/6PP/8/PP3P2/R1B2RK1 w - - 0 26",
+    "r1bqkb1r/ppp1pppp/2n2n2/3p4/3P4/2N4P/PPP1PPP1/R1BQKBNR w KQkq d6 0 4",
+    "6k1/2R5/5P2/6B1/5N2/8/P7/6K1 w - - 1 58",
+    "r1bqkb1r/ppppppp1/5n2/n6p/4P3/2NP1N2/PPP2PPP/R1BQKB1R w KQkq h6 0 5",
+    "1k6/8/1P6/2p5/5K1q/r7/8/8 w - - 4 59",
+    "1r1qkb1r/ppp1pppp/2n2n2/3p1b2/3P4/N4NP1/PPP1PP1P/1RBQKB1R w Kk - 1 6",
+    "r3kb2/1p2nppn/p2q4/1PpQ1b1p/8/N3p3/PBP2PPP/R3KB1R b q - 0 15",
+    "r1bqkb1r/ppp2ppp/2n2n2/4p3/P7/2N2P2/1PPPKP1P/R1BQ1B1R w kq e6 0 7",
+    "3r1rk1/pppb1pp1/2n1pqp1/3p4/2PP4/4P2P/PBPnBPP1/R1Q2RK1 b - - 1 16",
+    "r1bq1rk1/4ppbp/p2p2p1/1p1B2P1/3p4/P1N1P3/1PPNQ2P/R1BR2K1 w - - 0 17",
+    "r1b5/1ppr4/pqk3pp/6p1/3b1P2/3N4/PP1KB1PP/1R1n3R w - - 0 31",
+    "1n5r/2k3p1/1pP5/1p5p/3p3P/b2P2P1/P2K2B1/6RR b - - 1 27",
+    "7Q/p2bkp2/1p2p2p/2pp2n1/1B1P3P/2N1P1P1/PPP3P1/R3KR2 w Q - 1 19",
+    "r1bq1rk1/1ppp1ppp/p2b4/4n3/3QP3/P1N1B3/1PP2PPP/R3KB1R b KQ - 8 11",
+    "8/8/6p1/p1k5/P2N1P2/1P1R3P/1K6/8 b - - 4 65",
+    "r1b1k2r/1p1n1N2/2p2npp/4p3/1b2P2P/2RP1B2/n4PP1/Q3K2R w Kk - 0 21",
+    "8/2p3k1/2P1P2p/8/2B5/7P/2P4P/6K1 b - - 0 48",
+    "1k6/5p2/7p/8/2R5/7P/PPP3P1/7K b - - 0 35",
+    "8/1Q6/5k2/8/8/P7/1P6/6K1 b - - 32 89",
+    "1rb3k1/ppp1rppp/3b4/4n3/3P1P2/P1Q5/1PP3PP/R3KB1R w KQ - 0 14",
+    "r1bqk2r/ppp2ppp/2n1pn2/3p4/1b1P3P/2N1PN2/PPP2PP1/R1BQKB1R w KQkq - 1 6",
+};
+
+uint64_t runBench(int depth, int threads, int hashMb) {
+    Search search;
+    search.setOutput(nullptr);
+    search.setThreads(threads);
+    search.setHashSize(hashMb);
+
+    SearchLimits limits;
+    limits.depth = depth;
+
+    uint64_t totalNodes = 0, totalAllocations = 0;
+    auto begin = std::chrono::steady_clock::now();
+    int count = sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]);
+    for(int i = 0; i < count; i++) {
+        // Each position starts from empty tables so the result doesn't depend on the ones before it
+        search.newGame();
+        Board board(BENCH_FENS[i]);
+        search.start(board, limits);
+        search.wait();
+        totalNodes += search.getNodes();
+        totalAllocations += search.getAllocations();
+        std::cerr << "Position " << (i + 1) << "/" << count << ": " << search.getNodes() << " nodes, bestmove "
+                  << moveToString(search.getBestMove()) << std::endl;
+    }
+    int64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "===========================" << std::endl;
+    std::cout << "Total time (ms) : " << time << std::endl;
+    std::cout << "Nodes searched  : " << totalNodes << std::endl;
+    std::cout << "Nodes/second    : " << totalNodes * 1000 / (time + 1) << std::endl;
+#ifdef CHESS_ALLOC_COUNT
+    std::cout << "Allocations     : " << totalAllocations << std::endl;
+#endif
+    return totalNodes;
+}
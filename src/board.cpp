@@ -1,145 +1,492 @@
 #include "board.h"
+#include "stats.h"
+#include "training.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
 #include <list>
+#include <sstream>
 #include <string>
 
+// Castling rights which survive a move touching each square. The king and rook home squares clear their rights.
+static const unsigned char castleMask[8][8] = {
+    {15 & ~BLACK_QUEENSIDE, 15, 15, 15, 15 & ~(BLACK_KINGSIDE | BLACK_QUEENSIDE), 15, 15, 15 & ~BLACK_KINGSIDE},
+    {15, 15, 15, 15, 15, 15, 15, 15},
+    {15, 15, 15, 15, 15, 15, 15, 15},
+    {15, 15, 15, 15, 15, 15, 15, 15},
+    {15, 15, 15, 15, 15, 15, 15, 15},
+    {15, 15, 15, 15, 15, 15, 15, 15},
+    {15, 15, 15, 15, 15, 15, 15, 15},
+    {15 & ~WHITE_QUEENSIDE, 15, 15, 15, 15 & ~(WHITE_KINGSIDE | WHITE_QUEENSIDE), 15, 15, 15 & ~WHITE_KINGSIDE}
+};
+
+static const int knightOffsets[8][2] = {{-2,-1},{-2,1},{2,1},{2,-1},{-1,-2},{-1,2},{1,2},{1,-2}};
+static const int kingOffsets[8][2] = {{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}};
+
+// Builds a piece from its lowercase type character. Used by FEN parsing and promotions.
+static Piece makePiece(char type, bool isWhite, int r, int c) {
+    switch(type) {
+        case 'p':
+            return Pawn(isWhite, r, c);
+        case 'n':
+            return Knight(isWhite, r, c);
+        case 'b':
+            return Bishop(isWhite, r, c);
+        case 'r':
+            return Rook(isWhite, r, c);
+        case 'q':
+            return Queen(isWhite, r, c);
+        case 'k':
+            return King(isWhite, r, c);
+    }
+    return Piece();
+}
+
+// Zobrist hashing. Every piece on every square, castling state, en passant column and the side to move
+// gets a random key, and a position's key is the XOR of the keys of everything present in it.
+struct ZobristKeys {
+    uint64_t pieces[12][64];
+    uint64_t castle[16];
+    uint64_t ep[8];
+    uint64_t side;
+
+    // Fixed seed so keys (and anything stored with them) are the same on every run
+    ZobristKeys() {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+        for(unsigned int i = 0; i < 12; i++) {
+            for(unsigned int j = 0; j < 64; j++) {
+                pieces[i][j] = next(seed);
+            }
+        }
+        for(unsigned int i = 0; i < 16; i++) {
+            castle[i] = next(seed);
+        }
+        for(unsigned int i = 0; i < 8; i++) {
+            ep[i] = next(seed);
+        }
+        side = next(seed);
+    }
+
+    // splitmix64
+    static uint64_t next(uint64_t& seed) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+static const ZobristKeys zobrist;
+
+static uint64_t pieceKey(const Piece& p, unsigned int r, unsigned int c) {
+    static const std::string types = "pnbrqk";
+    unsigned int index = types.find(p.pieceType) + ((p.isWhite) ? 0 : 6);
+    return zobrist.pieces[index][r*8 + c];
+}
+
 // BOARD-ONLY FUNCTIONS START HERE
 
 Board::Board() {
-    // Initial "power" pieces have to be manually assigned
-    boardPieces[0][0] = Rook(false, 0, 0);
-    boardPieces[7][0] = Rook(true, 7, 0);
-    boardPieces[0][1] = Knight(false, 0, 1);
-    boardPieces[7][1] = Knight(true, 7, 1);
-    boardPieces[0][2] = Bishop(false, 0, 2);
-    boardPieces[7][2] = Bishop(true, 7, 2);
-    boardPieces[0][3] = Queen(false, 0, 3);
-    boardPieces[7][3] = Queen(true, 7, 3);
-    boardPieces[0][4] = King(false, 0, 4);
-    boardPieces[7][4] = King(true, 7, 4);
-    boardPieces[0][5] = Bishop(false, 0, 5);
-    boardPieces[7][5] = Bishop(true, 7, 5);
-    boardPieces[0][6] = Knight(false, 0, 6);
-    boardPieces[7][6] = Knight(true, 7, 6);
-    boardPieces[0][7] = Rook(false, 0, 7);
-    boardPieces[7][7] = Rook(true, 7, 7);
-    // Loop assign for pawns
-    for(unsigned int i = 0; i < 7; i++) {
-        boardPieces[1][i] = Pawn(false, 1, i);
-        boardPieces[6][i] = Pawn(true, 6, i);
-    }
-    // Add all above pieces to sets of black X white pieces
-    for(unsigned int i = 0; i < 3; i++) {
-        for(unsigned int j = 0; j < 8; j++) {
-            blackPieces.push_back(boardPieces[i][j]);
-            whitePieces.push_back(boardPieces[i+6][j]);
+    setFen(START_FEN);
+}
+
+Board::Board(const std::string& fen) {
+    if(!setFen(fen)) {
+        setFen(START_FEN);
+    }
+}
+
+// Loads a position from FEN. Returns false (leaving the board empty) if the piece placement is malformed.
+bool Board::setFen(const std::string& fen) {
+    std::istringstream ss(fen);
+    std::string placement, side, castling, ep;
+    ss >> placement >> side >> castling >> ep;
+    if(!(ss >> halfmoveClock)) {
+        halfmoveClock = 0;
+    }
+    if(!(ss >> fullmoveNumber)) {
+        fullmoveNumber = 1;
+    }
+
+    clear();
+
+    // Placement runs from row 0 (rank 8) down to row 7 (rank 1), matching boardPieces
+    unsigned int r = 0, c = 0;
+    for(char ch : placement) {
+        if(ch == '/') {
+            r++;
+            c = 0;
+        } else if(isdigit(ch)) {
+            c += ch - '0';
+        } else {
+            if(r > 7 || c > 7) {
+                return false;
+            }
+            if(!placePiece(tolower(ch), isupper(ch), r, c)) {
+                return false;
+            }
+            c++;
         }
     }
 
-    isUpdated = true;
+    whiteToMove = (side != "b");
+    castleRights = 0;
+    for(char ch : castling) {
+        switch(ch) {
+            case 'K': castleRights |= WHITE_KINGSIDE; break;
+            case 'Q': castleRights |= WHITE_QUEENSIDE; break;
+            case 'k': castleRights |= BLACK_KINGSIDE; break;
+            case 'q': castleRights |= BLACK_QUEENSIDE; break;
+        }
+    }
+    epColumn = (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h') ? ep[0] - 'a' : -1;
+    key = computeKey();
+
+    isUpdated = false;
+    whiteAttack = blackAttack = 0x0000000000000000;
+    return whiteKing.first < 8 && blackKing.first < 8;
+}
+
+// Empties the board ahead of setting up a new position
+void Board::clear() {
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            boardPieces[r][c] = Piece();
+        }
+    }
+    moveHistory.clear();
+    whiteKing = blackKing = std::make_pair(8u, 8u);
+}
+
+// Puts a new piece on an empty board square during setup. Returns false for an unknown type.
+bool Board::placePiece(char type, bool isWhite, unsigned int r, unsigned int c) {
+    boardPieces[r][c] = makePiece(type, isWhite, r, c);
+    if(boardPieces[r][c].isNull()) {
+        return false;
+    }
+    if(type == 'k') {
+        (isWhite ? whiteKing : blackKing) = std::make_pair(r, c);
+    }
+    return true;
+}
+
+// Piece nibbles in packed positions: the type's index in this string, plus 8 for black
+static const char packedTypes[] = " pnbrqk";
+
+void Board::pack(PackedPosition& packed) const {
+    packed.occupancy = 0;
+    std::fill(packed.pieces, packed.pieces + 16, 0);
+    unsigned int count = 0;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = boardPieces[r][c];
+            if(p.isNull() || count == 32) {
+                continue;
+            }
+            uint8_t nibble = (uint8_t)(std::strchr(packedTypes, p.pieceType) - packedTypes) | (p.isWhite ? 0 : 8);
+            packed.occupancy |= (uint64_t)1 << (r*8 + c);
+            packed.pieces[count / 2] |= nibble << ((count % 2) * 4);
+            count++;
+        }
+    }
+    packed.sideToMove = whiteToMove ? 0 : 1;
+    packed.castleRights = castleRights;
+    packed.epColumn = (int8_t)epColumn;
+    packed.halfmoveClock = (uint8_t)std::min(halfmoveClock, 255);
+    packed.fullmoveNumber = (uint16_t)std::min(fullmoveNumber, 65535);
+    packed.reserved = 0;
+}
+
+// Sets up the position without going through FEN. Returns false if the packed data is corrupt.
+bool Board::unpack(const PackedPosition& packed) {
+    clear();
+    uint64_t occupancy = packed.occupancy;
+    for(unsigned int count = 0; occupancy != 0 && count < 32; count++) {
+        unsigned int index = 0;
+        while(!(occupancy & ((uint64_t)1 << index))) {
+            index++;
+        }
+        occupancy &= occupancy - 1;
+        uint8_t nibble = (packed.pieces[count / 2] >> ((count % 2) * 4)) & 15;
+        if((nibble & 7) == 0 || (nibble & 7) > 6) {
+            return false;
+        }
+        placePiece(packedTypes[nibble & 7], (nibble & 8) == 0, index / 8, index % 8);
+    }
+    whiteToMove = (packed.sideToMove == 0);
+    castleRights = packed.castleRights & 15;
+    epColumn = (packed.epColumn >= 0 && packed.epColumn < 8) ? packed.epColumn : -1;
+    halfmoveClock = packed.halfmoveClock;
+    fullmoveNumber = std::max((int)packed.fullmoveNumber, 1);
+    key = computeKey();
+
+    isUpdated = false;
     whiteAttack = blackAttack = 0x0000000000000000;
+    return whiteKing.first < 8 && blackKing.first < 8;
+}
+
+std::string Board::getFen() const {
+    std::string fen;
+    for(unsigned int r = 0; r < 8; r++) {
+        int empty = 0;
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = boardPieces[r][c];
+            if(p.isNull()) {
+                empty++;
+                continue;
+            }
+            if(empty > 0) {
+                fen += (char)('0' + empty);
+                empty = 0;
+            }
+            fen += p.isWhite ? (char)toupper(p.pieceType) : p.pieceType;
+        }
+        if(empty > 0) {
+            fen += (char)('0' + empty);
+        }
+        if(r < 7) {
+            fen += '/';
+        }
+    }
+    fen += whiteToMove ? " w " : " b ";
+    if(castleRights == 0) {
+        fen += '-';
+    }
+    if(castleRights & WHITE_KINGSIDE) fen += 'K';
+    if(castleRights & WHITE_QUEENSIDE) fen += 'Q';
+    if(castleRights & BLACK_KINGSIDE) fen += 'k';
+    if(castleRights & BLACK_QUEENSIDE) fen += 'q';
+    if(epColumn >= 0) {
+        fen += ' ';
+        fen += (char)('a' + epColumn);
+        fen += whiteToMove ? '6' : '3';
+    } else {
+        fen += " -";
+    }
+    fen += " " + std::to_string(halfmoveClock) + " " + std::to_string(fullmoveNumber);
+    return fen;
+}
+
+// Builds the Zobrist key from scratch. forwardMove keeps it up to date incrementally after that.
+uint64_t Board::computeKey() const {
+    uint64_t k = zobrist.castle[castleRights];
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            if(!boardPieces[r][c].isNull()) {
+                k ^= pieceKey(boardPieces[r][c],r,c);
+            }
+        }
+    }
+    if(epColumn >= 0) {
+        k ^= zobrist.ep[epColumn];
+    }
+    if(!whiteToMove) {
+        k ^= zobrist.side;
+    }
+    return k;
+}
+
+// Checks if the current position occurred before with the same side to move. Only positions since the
+// last capture or pawn move can repeat, which halfmoveClock counts.
+bool Board::isRepetition() const {
+    int oldest = std::max(0, (int)moveHistory.size() - halfmoveClock);
+    for(int i = (int)moveHistory.size() - 2; i >= oldest; i -= 2) {
+        if(moveHistory[i].key == key) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // Adds a single bit to a bitboard
 void bitboardAdd(unsigned int r, unsigned int c, Bitboard& b) {
     // Shift a "1" bit to the correct position
-    Bitboard temp = 0x0000000000000001 << (r*8 + c);
+    Bitboard temp = (Bitboard)1 << (r*8 + c);
     // Include all bits in b plus the new bit
     b = b | temp;
 }
 
 // Checks for the existance of a single bit in a bitboard
-bool bitboardHas(unsigned int r, unsigned c, Bitboard& b) {
+bool bitboardHas(unsigned int r, unsigned c, const Bitboard& b) {
     // Shifts a "1" bit to the correct position
-    Bitboard temp = 0x0000000000000001 << (r*8 + c);
+    Bitboard temp = (Bitboard)1 << (r*8 + c);
     // Returns 0 for all bits except the correct one, which will return 1 if it's 1 too
-    temp &= b;
-    // Check that the integers are equal
-    return b == temp;
+    return (b & temp) != 0;
 }
 
-void Board::addCastle(bool isWhite) {
-    // Bitboard of enemy moves for checking for check and enemy sight
-    Bitboard b = (isWhite) ? blackAttack : whiteAttack;
-
-    King* k  = (isWhite) ? whiteKing : blackKing;
-    unsigned int r = k->location.first;
-    unsigned int c = k->location.second;
-    // Make sure the king is not in check
-    if(bitboardHas(r,c,b)) {
-        return;
-    }
-    // Check that the king has not moved
-    if(k->pieceMoved) {
-        return;
+// Promotions carry their own move code, so they only count as captures if the target square is occupied
+bool Board::isCapture(const Move& m) const {
+    char type = std::get<2>(m);
+    if(type == 'X' || type == 'E') {
+        return true;
     }
-    // Check vacancy around King and that corresponding rooks have not been moved
-    bool queensideOpen = false;
-    bool kingsideOpen = false;
-    if(boardPieces[r][c-1].isNull() && boardPieces[r][c-2].isNull() && boardPieces[r][c-3].isNull()) {
-        if(!boardPieces[r][0].isNull() && boardPieces[r][0].pieceType == 'r') {
-            Rook* rook = (Rook*)(&boardPieces[r][0]);
-            if(!rook->pieceMoved) {
-                queensideOpen = true;
+    return isPromotion(m) && !boardPieces[std::get<1>(m).first][std::get<1>(m).second].isNull();
+}
+
+// Checks whether any piece of the given color attacks a square. Works outward from the square,
+// so unlike whiteAttack/blackAttack it never needs the moves of the other side generated first.
+bool Board::isAttacked(unsigned int r, unsigned int c, bool byWhite) const {
+    int row = r, col = c;
+    // Pawns attack diagonally forward, so a white attacker sits one row below the square
+    int pr = (byWhite) ? row + 1 : row - 1;
+    if(pr >= 0 && pr < 8) {
+        for(int dc = -1; dc <= 1; dc += 2) {
+            int pc = col + dc;
+            if(pc >= 0 && pc < 8) {
+                const Piece& p = boardPieces[pr][pc];
+                if(p.pieceType == 'p' && p.isWhite == byWhite) {
+                    return true;
+                }
             }
         }
     }
-    if(boardPieces[r][c+1].isNull() && boardPieces[r][c+2].isNull()) {
-        if(!boardPieces[r][7].isNull() && boardPieces[r][7].pieceType == 'r') {
-            Rook* rook = (Rook*)(&boardPieces[r][7]);
-            if(!rook->pieceMoved) {
-                queensideOpen = true;
+    // Knights and kings
+    for(unsigned int i = 0; i < 8; i++) {
+        int nr = row + knightOffsets[i][0], nc = col + knightOffsets[i][1];
+        if(nr >= 0 && nr < 8 && nc >= 0 && nc < 8) {
+            const Piece& p = boardPieces[nr][nc];
+            if(p.pieceType == 'n' && p.isWhite == byWhite) {
+                return true;
+            }
+        }
+        int kr = row + kingOffsets[i][0], kc = col + kingOffsets[i][1];
+        if(kr >= 0 && kr < 8 && kc >= 0 && kc < 8) {
+            const Piece& p = boardPieces[kr][kc];
+            if(p.pieceType == 'k' && p.isWhite == byWhite) {
+                return true;
             }
         }
     }
-    // Ensure no spots inbetween are in the enemy's vision, including us (check)
-    for(unsigned int i = 1; i < 4 && queensideOpen; i++) {
-        if(bitboardHas(r,c-i,b)) {
-            queensideOpen = false;
+    // Sliding pieces. The first four directions are diagonal, the last four orthogonal.
+    for(unsigned int i = 0; i < 8; i++) {
+        int dr = kingOffsets[i][0], dc = kingOffsets[i][1];
+        bool diagonal = (dr != 0 && dc != 0);
+        for(int sr = row + dr, sc = col + dc; sr >= 0 && sr < 8 && sc >= 0 && sc < 8; sr += dr, sc += dc) {
+            const Piece& p = boardPieces[sr][sc];
+            if(p.isNull()) {
+                continue;
+            }
+            if(p.isWhite == byWhite && (p.pieceType == 'q' || p.pieceType == (diagonal ? 'b' : 'r'))) {
+                return true;
+            }
             break;
         }
     }
-    for(unsigned int i = 1; i < 3 && kingsideOpen; i++) {
-        if(bitboardHas(r,c+i,b)) {
-            kingsideOpen = false;
-            break;
+    return false;
+}
+
+// Whether the piece on (r,c) attacks (tr,tc), regardless of whose turn it is
+bool Board::attacksSquare(unsigned int r, unsigned int c, unsigned int tr, unsigned int tc) const {
+    const Piece& p = boardPieces[r][c];
+    int dr = (int)tr - (int)r, dc = (int)tc - (int)c;
+    switch(p.pieceType) {
+        case 'p':
+            return dr == ((p.isWhite) ? -1 : 1) && std::abs(dc) == 1;
+        case 'n':
+            return std::abs(dr * dc) == 2;
+        case 'k':
+            return std::max(std::abs(dr), std::abs(dc)) == 1;
+        case 'b':
+        case 'r':
+        case 'q': {
+            bool diagonal = std::abs(dr) == std::abs(dc);
+            bool straight = dr == 0 || dc == 0;
+            if((dr == 0 && dc == 0) || !(p.pieceType == 'b' ? diagonal : p.pieceType == 'r' ? straight : diagonal || straight)) {
+                return false;
+            }
+            int sr = (dr > 0) - (dr < 0), sc = (dc > 0) - (dc < 0);
+            for(int r2 = r + sr, c2 = c + sc; r2 != (int)tr || c2 != (int)tc; r2 += sr, c2 += sc) {
+                if(!boardPieces[r2][c2].isNull()) {
+                    return false;
+                }
+            }
+            return true;
         }
     }
-    // Add either pending which is "true"
-    if(queensideOpen) {
-        Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r, c-2),'C');
-        k->moveList.push_back(m);
+    return false;
+}
+
+// Whether the side can castle to the given side right now: rights held, the squares between king and
+// rook empty, and the king not in check nor passing over an attacked square
+bool Board::canCastle(bool isWhite, bool kingside) const {
+    unsigned char right = (isWhite) ? ((kingside) ? WHITE_KINGSIDE : WHITE_QUEENSIDE)
+                                    : ((kingside) ? BLACK_KINGSIDE : BLACK_QUEENSIDE);
+    if(!(castleRights & right)) {
+        return false;
+    }
+    Square k = (isWhite) ? whiteKing : blackKing;
+    unsigned int r = k.first;
+    unsigned int c = k.second;
+    // Rights can only be held by a king on its home square
+    if(r != ((isWhite) ? 7u : 0u) || c != 4) {
+        return false;
     }
-    if(kingsideOpen) {
-        Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r, c+2),'C');
-        k->moveList.push_back(m);
+    // Check vacancy around King and that the corresponding rook is still in place
+    const Piece& rook = boardPieces[r][(kingside) ? 7 : 0];
+    if(rook.pieceType != 'r' || rook.isWhite != isWhite) {
+        return false;
+    }
+    if(kingside ? !(boardPieces[r][c+1].isNull() && boardPieces[r][c+2].isNull())
+                : !(boardPieces[r][c-1].isNull() && boardPieces[r][c-2].isNull() && boardPieces[r][c-3].isNull())) {
+        return false;
+    }
+    // Ensure the king isn't in check and no spots it passes over are in the enemy's vision
+    for(unsigned int i = 0; i < 3; i++) {
+        if(isAttacked(r, (kingside) ? c+i : c-i, !isWhite)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adds the castling moves available to the given side
+void Board::addCastle(bool isWhite, MoveList& moves) {
+    Square k = (isWhite) ? whiteKing : blackKing;
+    if(canCastle(isWhite, false)) {
+        moves.push_back(std::make_tuple(k, std::make_pair(k.first, k.second-2), 'C'));
+    }
+    if(canCastle(isWhite, true)) {
+        moves.push_back(std::make_tuple(k, std::make_pair(k.first, k.second+2), 'C'));
     }
 }
 
 // Utility functions to help with generateMoves for each piece
-// PIECE-SPECIFIC generateMoves do not account for checks. This is because checks require us to have 
-// generated the moves of the other pieces, i.e. circular dependency. Checks are done after all moves 
+// PIECE-SPECIFIC generateMoves do not account for checks. This is because checks require us to have
+// generated the moves of the other pieces, i.e. circular dependency. Checks are done after all moves
 // have been generated.
 
+// Adds a pawn move, expanding it into the four promotions when it reaches the last row
+static void addPawnMove(MoveList& moves, const Square& from, const Square& to, char type) {
+    if(to.first == 0 || to.first == 7) {
+        moves.push_back(std::make_tuple(from, to, 'q'));
+        moves.push_back(std::make_tuple(from, to, 'r'));
+        moves.push_back(std::make_tuple(from, to, 'b'));
+        moves.push_back(std::make_tuple(from, to, 'n'));
+    } else {
+        moves.push_back(std::make_tuple(from, to, type));
+    }
+}
+
 // Functions kept general with Piece* pointers rather than their specific types as it avoids the requirement of certain casts
-void Board::generateMovesPawn(unsigned int r, unsigned int c, Piece* p) {
+void Board::generateMovesPawn(unsigned int r, unsigned int c, const Piece* p, MoveList& moves) {
     // Select correct bitboard of attacking moves, add each move to bitboard
-    Bitboard b = (p->isWhite) ? whiteAttack : blackAttack;
-    // Downcast from Piece to Pawn
-    Pawn* pawn_p = (Pawn*)p;
-    // Moving 1 or 2 squares forward
-    int i = (pawn_p->isWhite) ? -1 : 1;
+    Bitboard& b = (p->isWhite) ? whiteAttack : blackAttack;
+    Square from = std::make_pair(r,c);
+    // Moving 1 or 2 squares forward. Pawns never stand on the last row, so r + i is always on the board.
+    int i = (p->isWhite) ? -1 : 1;
+    unsigned int startRow = (p->isWhite) ? 6 : 1;
     if(boardPieces[r+i][c].isNull()) {
-        Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c),'N');
-        pawn_p->moveList.push_back(m);
-    }
-    if(boardPieces[r+2*i][c].isNull() && !pawn_p->pieceMoved) {
-        Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + 2*i, c),'N');
-        pawn_p->moveList.push_back(m);
+        addPawnMove(moves, from, std::make_pair(r + i, c), 'N');
+        if(r == startRow && boardPieces[r+2*i][c].isNull()) {
+            Move m = std::make_tuple(from,std::make_pair(r + 2*i, c),'N');
+            moves.push_back(m);
+        }
     }
 
-    // Diagonal moves are the only ones added to whiteAttack and blackAttack bitboards as they are the only 
+    // Diagonal moves are the only ones added to whiteAttack and blackAttack bitboards as they are the only
     // moves we can capture. They are always added.
-    if(c - 1 >= 0) {
+    if(c >= 1) {
         bitboardAdd(r+i,c-1,b);
     }
     if(c + 1 < 8) {
@@ -147,134 +494,87 @@ void Board::generateMovesPawn(unsigned int r, unsigned int c, Piece* p) {
     }
 
     // Capturing pieces diagonally
-    if(c - 1 >= 0 && !boardPieces[r+i][c-1].isNull() && !isSameColor(*p,boardPieces[r+i][c-1])) {
-        Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c - 1),'X');
-        p->moveList.push_back(m);
+    if(c >= 1 && !boardPieces[r+i][c-1].isNull() && !isSameColor(*p,boardPieces[r+i][c-1])) {
+        addPawnMove(moves, from, std::make_pair(r + i, c - 1), 'X');
     }
     if(c + 1 < 8 && !boardPieces[r+i][c+1].isNull() && !isSameColor(*p,boardPieces[r+i][c+1])) {
-        Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c + 1),'X');
-        p->moveList.push_back(m);
+        addPawnMove(moves, from, std::make_pair(r + i, c + 1), 'X');
     }
 
     // En Passant
-    // When the opposing pawn moves +2 you can take diagonally.
-    // Logic: Check if opposing color pawn is next to us L/R. Check if either was moved +2 last move.
+    // When the opposing pawn moves +2 you can take diagonally, but only on the very next move.
+    // epColumn holds the column of that pawn, which must be beside us on our fifth row.
+    unsigned int epRow = (p->isWhite) ? 3 : 4;
+    if(epColumn >= 0 && p->isWhite == whiteToMove && r == epRow && std::abs((int)c - epColumn) == 1) {
+        Move m = std::make_tuple(from,std::make_pair(r + i,(unsigned int)epColumn),'E');
+        moves.push_back(m);
+    }
+}
 
-    if(c - 1 >= 0 && !boardPieces[r][c-1].isNull() && !isSameColor(*p,boardPieces[r][c-1]) && boardPieces[r][c-1].pieceType == 'p') {
-        // For a pawn of the opposite color on the left of the current piece:
-        pawn_p = (Pawn*)&boardPieces[r][c-1];
-        // Further check that this adjacent pawn was moved +2 last turn.
-        if((r == 3 || r == 4) && pawn_p->pieceMoved && !pawn_p->pieceMovedTwice) {
-            Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i,c - 1),'E');
-            p->moveList.push_back(m);
+void Board::generateMovesKnight(unsigned int r, unsigned int c, const Piece* p, MoveList& moves) {
+    // Select correct bitboard of attacking moves, add each move to bitboard
+    Bitboard& b = (p->isWhite) ? whiteAttack : blackAttack;
+    // Check bounds. The spot to move to must either be empty or the opposite color (capture)
+    for(unsigned int i = 0; i < 8; i++) {
+        int r2 = r + knightOffsets[i][0];
+        int c2 = c + knightOffsets[i][1];
+        if(r2 < 0 || r2 >= 8 || c2 < 0 || c2 >= 8) {
+            continue;
         }
-    }
-    if(c + 1 < 8 && !boardPieces[r][c+1].isNull() && !isSameColor(*p,boardPieces[r][c+1]) && boardPieces[r][c+1].pieceType == 'p') {
-        // For a pawn of the opposite color on the left of the current piece:
-        pawn_p = (Pawn*)&boardPieces[r][c+1];
-        // Further check that this adjacent pawn was moved +2 last turn.
-        if((r == 3 || r == 4) && pawn_p->pieceMoved && !pawn_p->pieceMovedTwice) {
-            Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i,c + 1),'E');
-            p->moveList.push_back(m);
+        const Piece& target = boardPieces[r2][c2];
+        if(target.isNull() || !isSameColor(*p,target)) {
+            Square loc = std::make_pair(r2, c2);
+            Move m = std::make_tuple(std::make_pair(r,c),loc,(target.isNull()) ? 'N' : 'X');
+            moves.push_back(m);
+            bitboardAdd(r2,c2,b);
         }
     }
 }
 
-void Board::generateMovesKnight(unsigned int r, unsigned int c, Piece* p) {
-    // Select correct bitboard of attacking moves, add each move to bitboard
-    Bitboard b = (p->isWhite) ? whiteAttack : blackAttack;
-    // Check bounds. The spot to move to must either be empty or the opposite color (capture)
-    if(r - 2 >= 0 && c - 1 >= 0 && (boardPieces[r-2][c-1].isNull() || !isSameColor(*p,boardPieces[r-2][c-1]))) {
-        Square loc = std::make_pair(r - 2, c - 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-2,c-1,b);
-    }
-    if(r - 2 >= 0 && c + 1 < 8 && (boardPieces[r-2][c+1].isNull() || !isSameColor(*p,boardPieces[r-2][c+1]))) {
-        Square loc = std::make_pair(r - 2, c + 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-2,c+1,b);
-    }
-    if(r + 2 < 8 && c + 1 < 8 && (boardPieces[r+2][c+1].isNull() || !isSameColor(*p,boardPieces[r+2][c+1]))) {
-        Square loc = std::make_pair(r + 2, c + 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+2,c+1,b);
-    }
-    if(r + 2 < 8 && c - 1 >= 0 && (boardPieces[r+2][c-1].isNull() || !isSameColor(*p,boardPieces[r+2][c-1]))) {
-        Square loc = std::make_pair(r + 2, c - 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+2,c-1,b);
-    }
-    if(r - 1 >= 0 && c - 2 >= 0 && (boardPieces[r-1][c-2].isNull() || !isSameColor(*p,boardPieces[r-1][c-2]))) {
-        Square loc = std::make_pair(r - 1, c - 2);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-1,c-2,b);
-    }
-    if(r - 1 >= 0 && c + 2 < 8 && (boardPieces[r-1][c+2].isNull() || !isSameColor(*p,boardPieces[r-1][c+2]))) {
-        Square loc = std::make_pair(r - 1, c + 2);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-1,c+2,b);
-    }
-    if(r + 1 < 8 && c + 2 < 8 && (boardPieces[r+1][c+2].isNull() || !isSameColor(*p,boardPieces[r+1][c+2]))) {
-        Square loc = std::make_pair(r + 1, c + 2);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+1,c+2,b);
-    }
-    if(r + 1 < 8 && c - 2 >= 0 && (boardPieces[r+1][c-2].isNull() || !isSameColor(*p,boardPieces[r+1][c-2]))) {
-        Square loc = std::make_pair(r + 1, c - 2);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+1,c-2,b);
-    }
-}
-
-void Board::generateMovesBishop(unsigned int r, unsigned int c, Piece* p) {
+void Board::generateMovesBishop(unsigned int r, unsigned int c, const Piece* p, MoveList& moves) {
     // Select correct bitboard of attacking moves, add each move to bitboard
-    Bitboard b = (p->isWhite) ? whiteAttack : blackAttack;
+    Bitboard& b = (p->isWhite) ? whiteAttack : blackAttack;
     // Northwest Loop
-    for(unsigned int i = 1; r - i >= 0 && c - i >= 0; i++) {
+    for(unsigned int i = 1; i <= r && i <= c; i++) {
         if(boardPieces[r-i][c-i].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r - i, c - i),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r-i,c-i,b);
         } else if(!isSameColor(*p,boardPieces[r-i][c-i])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r - i, c - i),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r-i,c-i,b);
+            break;
         } else {
             break;
         }
     }
     // Northeast Loop
-    for(unsigned int i = 1; r - i >= 0 && c + i < 8; i++) {
+    for(unsigned int i = 1; i <= r && c + i < 8; i++) {
         if(boardPieces[r-i][c+i].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r - i, c + i),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r-i,c+i,b);
         } else if(!isSameColor(*p,boardPieces[r-i][c+i])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r - i, c + i),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r-i,c+i,b);
+            break;
         } else {
             break;
         }
     }
     // Southwest Loop
-    for(unsigned int i = 1; r + i < 8 && c - i >= 0; i++) {
+    for(unsigned int i = 1; r + i < 8 && i <= c; i++) {
         if(boardPieces[r+i][c-i].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c - i),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r+i,c-i,b);
         } else if(!isSameColor(*p,boardPieces[r+i][c-i])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c - i),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r+i,c-i,b);
+            break;
         } else {
             break;
         }
@@ -283,31 +583,33 @@ void Board::generateMovesBishop(unsigned int r, unsigned int c, Piece* p) {
     for(unsigned int i = 1; r + i < 8 && c + i < 8; i++) {
         if(boardPieces[r+i][c+i].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c + i),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r+i,c+i,b);
         } else if(!isSameColor(*p,boardPieces[r+i][c+i])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c + i),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r+i,c+i,b);
+            break;
         } else {
             break;
         }
     }
 }
 
-void Board::generateMovesRook(unsigned int r, unsigned int c, Piece* p) {
+void Board::generateMovesRook(unsigned int r, unsigned int c, const Piece* p, MoveList& moves) {
     // Select correct bitboard of attacking moves, add each move to bitboard
-    Bitboard b = (p->isWhite) ? whiteAttack : blackAttack;
+    Bitboard& b = (p->isWhite) ? whiteAttack : blackAttack;
     // North Loop
-    for(unsigned int i = 1; r - i >= 0; i++) {
+    for(unsigned int i = 1; i <= r; i++) {
         if(boardPieces[r-i][c].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r - i, c),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r-i,c,b);
         } else if(!isSameColor(*p,boardPieces[r-i][c])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r - i, c),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r-i,c,b);
+            break;
         } else {
             break;
         }
@@ -316,26 +618,28 @@ void Board::generateMovesRook(unsigned int r, unsigned int c, Piece* p) {
     for(unsigned int i = 1; r + i < 8; i++) {
         if(boardPieces[r+i][c].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r+i,c,b);
         } else if(!isSameColor(*p,boardPieces[r+i][c])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r + i, c),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r+i,c,b);
+            break;
         } else {
             break;
         }
     }
     // West Loop
-    for(unsigned int i = 1; c - i >= 0; i++) {
+    for(unsigned int i = 1; i <= c; i++) {
         if(boardPieces[r][c-i].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r, c - i),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r,c-i,b);
         } else if(!isSameColor(*p,boardPieces[r][c-i])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r, c - i),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r,c-i,b);
+            break;
         } else {
             break;
         }
@@ -344,108 +648,387 @@ void Board::generateMovesRook(unsigned int r, unsigned int c, Piece* p) {
     for(unsigned int i = 1; c + i < 8; i++) {
         if(boardPieces[r][c+i].isNull()) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r, c + i),'N');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r,c+i,b);
         } else if(!isSameColor(*p,boardPieces[r][c+i])) {
             Move m = std::make_tuple(std::make_pair(r,c),std::make_pair(r, c + i),'X');
-            p->moveList.push_back(m);
+            moves.push_back(m);
             bitboardAdd(r,c+i,b);
+            break;
         } else {
             break;
         }
     }
 }
 
-void Board::generateMovesQueen(unsigned int r, unsigned int c, Piece* p) {
+void Board::generateMovesQueen(unsigned int r, unsigned int c, const Piece* p, MoveList& moves) {
     // Queen is a combination of rook and bishop so the code is simplified
-    generateMovesBishop(r,c,p);
-    generateMovesRook(r,c,p);
+    generateMovesBishop(r,c,p,moves);
+    generateMovesRook(r,c,p,moves);
 }
 
-void Board::generateMovesKing(unsigned int r, unsigned int c, Piece* p) {
+void Board::generateMovesKing(unsigned int r, unsigned int c, const Piece* p, MoveList& moves) {
     // Select correct bitboard of attacking moves, add each move to bitboard
-    Bitboard b = (p->isWhite) ? whiteAttack : blackAttack;
+    Bitboard& b = (p->isWhite) ? whiteAttack : blackAttack;
     // Check the 8 spots around the king
-    if(r - 1 >= 0 && c - 1 >= 0 && (boardPieces[r-1][c-1].isNull() || !isSameColor(*p,boardPieces[r-1][c-1]))) {
-        Square loc = std::make_pair(r - 1, c - 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-1,c-1,b);
-    }
-    if(r - 1 >= 0 && (boardPieces[r-1][c].isNull() || !isSameColor(*p,boardPieces[r-1][c]))) {
-        Square loc = std::make_pair(r - 1, c);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-1,c,b);
-    }
-    if(r - 1 >= 0 && c + 1 < 8 && (boardPieces[r-1][c+1].isNull() || !isSameColor(*p,boardPieces[r-1][c+1]))) {
-        Square loc = std::make_pair(r - 1, c + 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r-1,c+1,b);
-    }
-    if(c - 1 >= 0 && (boardPieces[r][c-1].isNull() || !isSameColor(*p,boardPieces[r][c-1]))) {
-        Square loc = std::make_pair(r, c - 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r,c-1,b);
-    }
-    if(c + 1 < 8 && (boardPieces[r][c+1].isNull() || !isSameColor(*p,boardPieces[r][c+1]))) {
-        Square loc = std::make_pair(r, c + 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r,c+1,b);
-    }
-    if(r + 1 < 8 && c - 1 >= 0 && (boardPieces[r+1][c-1].isNull() || !isSameColor(*p,boardPieces[r+1][c-1]))) {
-        Square loc = std::make_pair(r + 1, c - 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+1,c-1,b);
-    }
-    if(r + 1 < 8 && (boardPieces[r+1][c].isNull() || !isSameColor(*p,boardPieces[r+1][c]))) {
-        Square loc = std::make_pair(r + 1, c);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+1,c,b);
-    }
-    if(r + 1 < 8 && c + 1 < 8 && (boardPieces[r+1][c+1].isNull() || !isSameColor(*p,boardPieces[r+1][c+1]))) {
-        Square loc = std::make_pair(r + 1, c + 1);
-        Move m = (p->isNull()) ? std::make_tuple(std::make_pair(r,c),loc,'N') : std::make_tuple(std::make_pair(r,c),loc,'X');
-        p->moveList.push_back(m);
-        bitboardAdd(r+1,c+1,b);
+    for(unsigned int i = 0; i < 8; i++) {
+        int r2 = r + kingOffsets[i][0];
+        int c2 = c + kingOffsets[i][1];
+        if(r2 < 0 || r2 >= 8 || c2 < 0 || c2 >= 8) {
+            continue;
+        }
+        const Piece& target = boardPieces[r2][c2];
+        if(target.isNull() || !isSameColor(*p,target)) {
+            Square loc = std::make_pair(r2, c2);
+            Move m = std::make_tuple(std::make_pair(r,c),loc,(target.isNull()) ? 'N' : 'X');
+            moves.push_back(m);
+            bitboardAdd(r2,c2,b);
+        }
     }
 }
 
 // Generates the moves for a specific piece
 // Does NOT take care of check due to circular dependencies
-void Board::generateMoves(Piece* p) {
+void Board::generateMoves(const Piece* p, MoveList& moves) {
     unsigned int r = p->location.first;
     unsigned int c = p->location.second;
-    std::list<Move>& moveList = p->moveList;
-    moveList.clear();
     // Call correct function for piece type
     switch(p->pieceType) {
         case 'p':
-            generateMovesPawn(r,c,p);
+            STAT_INC(movegen[0]);
+            generateMovesPawn(r,c,p,moves);
             break;
         case 'n':
-            generateMovesKnight(r,c,p);
+            STAT_INC(movegen[1]);
+            generateMovesKnight(r,c,p,moves);
             break;
         case 'b':
-            generateMovesBishop(r,c,p);
+            STAT_INC(movegen[2]);
+            generateMovesBishop(r,c,p,moves);
             break;
         case 'r':
-            generateMovesRook(r,c,p);
+            STAT_INC(movegen[3]);
+            generateMovesRook(r,c,p,moves);
             break;
         case 'q':
-            generateMovesQueen(r,c,p);
+            STAT_INC(movegen[4]);
+            generateMovesQueen(r,c,p,moves);
             break;
         case 'k':
-            generateMovesKing(r,c,p);
+            STAT_INC(movegen[5]);
+            generateMovesKing(r,c,p,moves);
+            if(p->isWhite == whiteToMove) {
+                addCastle(p->isWhite, moves);
+            }
             break;
     }
 }
 
+// The attack maps are filled in as a side effect of generating each piece's moves
+void Board::updateAttacks() {
+    whiteAttack = blackAttack = 0x0000000000000000;
+    MoveList moves;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece* p = &boardPieces[r][c];
+            if(!p->isNull()) {
+                moves.clear();
+                generateMoves(p, moves);
+            }
+        }
+    }
+}
+
+// Generates every legal move for the side to move
+void Board::generateLegalMoves(std::list<Move>& moves) {
+    MoveList pseudoLegal;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece* p = &boardPieces[r][c];
+            if(p->isNull() || p->isWhite != whiteToMove) {
+                continue;
+            }
+            generateMoves(p, pseudoLegal);
+        }
+    }
+    // Leave out any moves generated which leave our own king in check
+    for(const Move& m : pseudoLegal) {
+        if(!causesCheck(m)) {
+            moves.push_back(m);
+        }
+    }
+}
+
+// STAGED MOVE GENERATION
+// The search asks for one category of moves at a time for the side to move, so a node which cuts off
+// on its first capture never generates its quiet moves. These don't touch the attack maps, and like the
+// per-piece generators they leave legality to causesCheck.
+
+static inline Bitboard squareBit(unsigned int r, unsigned int c) {
+    return (Bitboard)1 << (r*8 + c);
+}
+
+// Generates captures and/or quiet moves for the side to move. Non-king moves must land on a square in
+// targets (evasions use it to restrict moves to capturing or blocking the checker). Castling is added
+// with the quiets when castle is set.
+void Board::generateStaged(MoveList& moves, bool captures, bool quiets, Bitboard targets, bool castle) {
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = boardPieces[r][c];
+            if(p.isNull() || p.isWhite != whiteToMove) {
+                continue;
+            }
+            Square from = std::make_pair(r,c);
+
+            if(p.pieceType == 'p') {
+                STAT_INC(movegen[0]);
+                // Pawns never stand on the last row, so r + i is always on the board
+                int i = (whiteToMove) ? -1 : 1;
+                unsigned int r2 = r + i;
+                bool promotes = (r2 == 0 || r2 == 7);
+                unsigned int startRow = (whiteToMove) ? 6 : 1;
+                // Promotions are grouped with captures, since they change the material just as much
+                if(boardPieces[r2][c].isNull()) {
+                    if((promotes ? captures : quiets) && (targets & squareBit(r2,c))) {
+                        addPawnMove(moves, from, std::make_pair(r2, c), 'N');
+                    }
+                    if(quiets && r == startRow && boardPieces[r2+i][c].isNull() && (targets & squareBit(r2+i,c))) {
+                        moves.push_back(std::make_tuple(from, std::make_pair(r2 + i, c), 'N'));
+                    }
+                }
+                if(!captures) {
+                    continue;
+                }
+                for(int dc = -1; dc <= 1; dc += 2) {
+                    int c2 = c + dc;
+                    if(c2 < 0 || c2 >= 8) {
+                        continue;
+                    }
+                    const Piece& target = boardPieces[r2][c2];
+                    if(!target.isNull() && target.isWhite != whiteToMove && (targets & squareBit(r2,c2))) {
+                        addPawnMove(moves, from, std::make_pair(r2, (unsigned int)c2), 'X');
+                    }
+                }
+                // The pawn taken en passant isn't on the destination square, so either may be a target
+                unsigned int epRow = (whiteToMove) ? 3 : 4;
+                if(epColumn >= 0 && r == epRow && std::abs((int)c - epColumn) == 1 &&
+                        (targets & (squareBit(r2,epColumn) | squareBit(r,epColumn)))) {
+                    moves.push_back(std::make_tuple(from, std::make_pair(r2, (unsigned int)epColumn), 'E'));
+                }
+            } else if(p.pieceType == 'n' || p.pieceType == 'k') {
+                bool isKing = p.pieceType == 'k';
+                STAT_INC(movegen[isKing ? 5 : 1]);
+                const int (*offsets)[2] = (isKing) ? kingOffsets : knightOffsets;
+                // A king in check has to step out of it, so it isn't limited to the targets
+                Bitboard allowed = (isKing) ? ~(Bitboard)0 : targets;
+                for(unsigned int i = 0; i < 8; i++) {
+                    int r2 = r + offsets[i][0];
+                    int c2 = c + offsets[i][1];
+                    if(r2 < 0 || r2 >= 8 || c2 < 0 || c2 >= 8 || !(allowed & squareBit(r2,c2))) {
+                        continue;
+                    }
+                    const Piece& target = boardPieces[r2][c2];
+                    if(target.isNull() ? quiets : (captures && target.isWhite != whiteToMove)) {
+                        moves.push_back(std::make_tuple(from, std::make_pair(r2, c2), (target.isNull()) ? 'N' : 'X'));
+                    }
+                }
+                if(isKing && quiets && castle) {
+                    addCastle(whiteToMove, moves);
+                }
+            } else {
+                STAT_INC(movegen[(p.pieceType == 'b') ? 2 : (p.pieceType == 'r') ? 3 : 4]);
+                for(unsigned int i = 0; i < 8; i++) {
+                    int dr = kingOffsets[i][0], dc = kingOffsets[i][1];
+                    bool diagonal = (dr != 0 && dc != 0);
+                    if((p.pieceType == 'b' && !diagonal) || (p.pieceType == 'r' && diagonal)) {
+                        continue;
+                    }
+                    for(int r2 = r + dr, c2 = c + dc; r2 >= 0 && r2 < 8 && c2 >= 0 && c2 < 8; r2 += dr, c2 += dc) {
+                        const Piece& target = boardPieces[r2][c2];
+                        bool allowed = (targets & squareBit(r2,c2)) != 0;
+                        if(target.isNull()) {
+                            if(quiets && allowed) {
+                                moves.push_back(std::make_tuple(from, std::make_pair(r2, c2), 'N'));
+                            }
+                            continue;
+                        }
+                        if(captures && allowed && target.isWhite != whiteToMove) {
+                            moves.push_back(std::make_tuple(from, std::make_pair(r2, c2), 'X'));
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Board::generateCaptures(MoveList& moves) {
+    generateStaged(moves, true, false, ~(Bitboard)0, false);
+}
+
+void Board::generateQuiets(MoveList& moves) {
+    generateStaged(moves, false, true, ~(Bitboard)0, true);
+}
+
+// Out of check there are only three options: move the king, capture the checker or block its line.
+// A double check leaves only the king.
+void Board::generateEvasions(MoveList& moves) {
+    const Square& k = (whiteToMove) ? whiteKing : blackKing;
+    int kr = k.first, kc = k.second;
+    int checkers = 0;
+    Bitboard targets = 0;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = boardPieces[r][c];
+            if(p.isNull() || p.isWhite == whiteToMove || !attacksSquare(r, c, kr, kc)) {
+                continue;
+            }
+            checkers++;
+            targets = squareBit(r,c);
+            // Squares between a sliding checker and the king can be blocked
+            if(p.pieceType == 'b' || p.pieceType == 'r' || p.pieceType == 'q') {
+                int dr = (kr > (int)r) - (kr < (int)r), dc = (kc > (int)c) - (kc < (int)c);
+                for(int r2 = r + dr, c2 = c + dc; r2 != kr || c2 != kc; r2 += dr, c2 += dc) {
+                    targets |= squareBit(r2,c2);
+                }
+            }
+        }
+    }
+    generateStaged(moves, true, true, (checkers == 1) ? targets : 0, false);
+}
+
+// Quiet moves which check the opponent's king, either directly or by moving out of the way of one of
+// our sliding pieces. Castling into check is left out.
+void Board::generateQuietChecks(MoveList& moves) {
+    const Square& k = (whiteToMove) ? blackKing : whiteKing;
+    int kr = k.first, kc = k.second;
+
+    // Squares from which each kind of piece would attack the king
+    Bitboard pawnChecks = 0, knightChecks = 0, diagonalChecks = 0, straightChecks = 0;
+    // Our pieces standing between one of our sliders and the king, with the direction of that line
+    Bitboard discoverers = 0;
+    int discoverDr[64], discoverDc[64];
+
+    // Our pawns move toward the king's side of the board, so they attack it from one row behind it
+    int pr = kr + ((whiteToMove) ? 1 : -1);
+    for(int dc = -1; dc <= 1 && pr >= 0 && pr < 8; dc += 2) {
+        if(kc + dc >= 0 && kc + dc < 8) {
+            pawnChecks |= squareBit(pr, kc + dc);
+        }
+    }
+    for(unsigned int i = 0; i < 8; i++) {
+        int nr = kr + knightOffsets[i][0], nc = kc + knightOffsets[i][1];
+        if(nr >= 0 && nr < 8 && nc >= 0 && nc < 8) {
+            knightChecks |= squareBit(nr,nc);
+        }
+    }
+    for(unsigned int i = 0; i < 8; i++) {
+        int dr = kingOffsets[i][0], dc = kingOffsets[i][1];
+        bool diagonal = (dr != 0 && dc != 0);
+        int blocker = -1;
+        for(int r = kr + dr, c = kc + dc; r >= 0 && r < 8 && c >= 0 && c < 8; r += dr, c += dc) {
+            const Piece& p = boardPieces[r][c];
+            if(p.isNull()) {
+                if(blocker < 0) {
+                    (diagonal ? diagonalChecks : straightChecks) |= squareBit(r,c);
+                }
+                continue;
+            }
+            if(blocker >= 0) {
+                if(p.isWhite == whiteToMove && (p.pieceType == 'q' || p.pieceType == (diagonal ? 'b' : 'r'))) {
+                    discoverers |= (Bitboard)1 << blocker;
+                    discoverDr[blocker] = dr;
+                    discoverDc[blocker] = dc;
+                }
+                break;
+            }
+            if(p.isWhite != whiteToMove) {
+                break;
+            }
+            blocker = r*8 + c;
+        }
+    }
+
+    MoveList quiets;
+    generateStaged(quiets, false, true, ~(Bitboard)0, false);
+    for(const Move& m : quiets) {
+        const Square& from = std::get<0>(m);
+        const Square& to = std::get<1>(m);
+        Bitboard toBit = squareBit(to.first, to.second);
+        bool check = false;
+        switch(boardPieces[from.first][from.second].pieceType) {
+            case 'p': check = (pawnChecks & toBit) != 0; break;
+            case 'n': check = (knightChecks & toBit) != 0; break;
+            case 'b': check = (diagonalChecks & toBit) != 0; break;
+            case 'r': check = (straightChecks & toBit) != 0; break;
+            case 'q': check = ((diagonalChecks | straightChecks) & toBit) != 0; break;
+        }
+        // Uncovers the slider behind it unless it stays on the same line
+        int index = from.first*8 + from.second;
+        if(!check && (discoverers & ((Bitboard)1 << index))) {
+            check = ((int)to.first - kr) * discoverDc[index] != ((int)to.second - kc) * discoverDr[index];
+        }
+        if(check) {
+            moves.push_back(m);
+        }
+    }
+}
+
+// Whether m could be played by the side to move, ignoring checks. Used to vet hash moves, which may
+// come from another position with the same key. Follows the rules of the generators, move code
+// included, without generating anything.
+bool Board::isPseudoLegal(const Move& m) const {
+    const Square& from = std::get<0>(m);
+    const Square& to = std::get<1>(m);
+    char type = std::get<2>(m);
+    if(isNullMove(m) || from.first >= 8 || from.second >= 8 || to.first >= 8 || to.second >= 8) {
+        return false;
+    }
+    const Piece& p = boardPieces[from.first][from.second];
+    if(p.isNull() || p.isWhite != whiteToMove) {
+        return false;
+    }
+    const Piece& target = boardPieces[to.first][to.second];
+    if(!target.isNull() && target.isWhite == whiteToMove) {
+        return false;
+    }
+    int dr = (int)to.first - (int)from.first, dc = (int)to.second - (int)from.second;
+
+    if(p.pieceType == 'p') {
+        int forward = (whiteToMove) ? -1 : 1;
+        bool lastRow = (to.first == 0 || to.first == 7);
+        if(type == 'E') {
+            return epColumn >= 0 && from.first == ((whiteToMove) ? 3u : 4u) && dr == forward &&
+                   (int)to.second == epColumn && std::abs(dc) == 1;
+        }
+        // Promotions take the code of the new piece, every other pawn move onto the last row is invalid
+        if(isPromotion(m) != lastRow || (!lastRow && type != 'N' && type != 'X')) {
+            return false;
+        }
+        if(dc == 0) {
+            if(!target.isNull() || (type != 'N' && !lastRow)) {
+                return false;
+            }
+            if(dr == forward) {
+                return true;
+            }
+            // Two squares from the starting row, over an empty square
+            return dr == 2 * forward && from.first == ((whiteToMove) ? 6u : 1u) &&
+                   boardPieces[from.first + forward][from.second].isNull();
+        }
+        return dr == forward && std::abs(dc) == 1 && !target.isNull() && (type == 'X' || lastRow);
+    }
+
+    if(type == 'C') {
+        return p.pieceType == 'k' && dr == 0 && std::abs(dc) == 2 && canCastle(whiteToMove, dc > 0);
+    }
+    if(type != ((target.isNull()) ? 'N' : 'X')) {
+        return false;
+    }
+    return attacksSquare(from.first, from.second, to.first, to.second);
+}
+
 // Performs a move (NOT FOR ACTUAL TURNS, ONLY LOOKING AHEAD)
 void Board::forwardMove(const Move& m) {
     unsigned int r1 = std::get<0>(m).first;
@@ -454,31 +1037,67 @@ void Board::forwardMove(const Move& m) {
     unsigned int c2 = std::get<1>(m).second;
     char type = std::get<2>(m);
 
-    Piece* p = &boardPieces[r1][c1];
-    lastCapturedPiece = &boardPieces[r2][c2];
+    // Save the state this move will overwrite
+    Undo u;
+    u.move = m;
+    u.castleRights = castleRights;
+    u.epColumn = epColumn;
+    u.halfmoveClock = halfmoveClock;
+    u.key = key;
+
+    bool isWhite = boardPieces[r1][c1].isWhite;
+    char pieceType = boardPieces[r1][c1].pieceType;
+    // Remove the old castling, en passant and moving piece keys. Everything else is XORed in as it changes.
+    key ^= zobrist.castle[castleRights] ^ pieceKey(boardPieces[r1][c1],r1,c1);
+    if(epColumn >= 0) {
+        key ^= zobrist.ep[epColumn];
+    }
     // Make move
     if(type == 'E') {
-        // If en passant, update lastCapturedPiece to the captured pawn (one spot below)
-        unsigned int i = (p->isWhite) ? -1 : 1;
-        lastCapturedPiece = &boardPieces[r2 - i][c2];
-
-        boardPieces[r2][c2] = boardPieces[r1][c1];
-        boardPieces[r1][c1] = Piece();
+        // If en passant, the captured pawn is beside the moving pawn rather than on the target square
+        key ^= pieceKey(boardPieces[r1][c2],r1,c2);
+        u.captured = std::move(boardPieces[r1][c2]);
+        boardPieces[r1][c2] = Piece();
+    } else {
+        if(!boardPieces[r2][c2].isNull()) {
+            key ^= pieceKey(boardPieces[r2][c2],r2,c2);
+        }
+        u.captured = std::move(boardPieces[r2][c2]);
     }
-    else if(type == 'C') {
-        boardPieces[r2][c2] = boardPieces[r1][c1];
-        boardPieces[r1][c1] = Piece();
+    boardPieces[r2][c2] = std::move(boardPieces[r1][c1]);
+    boardPieces[r1][c1] = Piece();
+    boardPieces[r2][c2].updateLocation(r2,c2);
+
+    if(type == 'C') {
         // Move rook
-        unsigned int rook_c1 = (c2 == 1) ? 0 : 7;
-        unsigned int rook_c2 = (c2 == 1) ? 3 : 5;
-        boardPieces[r2][rook_c2] = boardPieces[r2][c1];
+        unsigned int rook_c1 = (c2 == 2) ? 0 : 7;
+        unsigned int rook_c2 = (c2 == 2) ? 3 : 5;
+        boardPieces[r2][rook_c2] = std::move(boardPieces[r2][rook_c1]);
         boardPieces[r2][rook_c1] = Piece();
         boardPieces[r2][rook_c2].updateLocation(r2,rook_c2);
-    } else {
-        boardPieces[r2][c2] = boardPieces[r1][c1];
-        boardPieces[r1][c1] = Piece();
+        key ^= pieceKey(boardPieces[r2][rook_c2],r2,rook_c1) ^ pieceKey(boardPieces[r2][rook_c2],r2,rook_c2);
+    } else if(isPromotion(m)) {
+        boardPieces[r2][c2] = makePiece(type, isWhite, r2, c2);
+    }
+    key ^= pieceKey(boardPieces[r2][c2],r2,c2);
+    if(pieceType == 'k') {
+        (isWhite ? whiteKing : blackKing) = std::make_pair(r2, c2);
+    }
+
+    castleRights &= castleMask[r1][c1] & castleMask[r2][c2];
+    epColumn = (pieceType == 'p' && (r1 == r2 + 2 || r2 == r1 + 2)) ? (int)c1 : -1;
+    halfmoveClock = (pieceType == 'p' || !u.captured.isNull()) ? 0 : halfmoveClock + 1;
+    if(!isWhite) {
+        fullmoveNumber++;
+    }
+    whiteToMove = !isWhite;
+    key ^= zobrist.castle[castleRights] ^ zobrist.side;
+    if(epColumn >= 0) {
+        key ^= zobrist.ep[epColumn];
     }
-    p->updateLocation(r2,c2);
+
+    moveHistory.push_back(std::move(u));
+    isUpdated = false;
 }
 
 // Undoes a move (useful with forwardMove to look ahead moves without making a new board)
@@ -489,77 +1108,170 @@ void Board::reverseMove(const Move& m) {
     unsigned int r2 = std::get<1>(m).first;
     unsigned int c2 = std::get<1>(m).second;
     char type = std::get<2>(m);
+    Undo& u = moveHistory.back();
 
-    Piece* p = &boardPieces[r2][c2];
+    whiteToMove = !whiteToMove;
+    if(!whiteToMove) {
+        fullmoveNumber--;
+    }
+    // Promoted pieces turn back into the pawn that moved
+    if(isPromotion(m)) {
+        boardPieces[r2][c2] = Pawn(whiteToMove, r2, c2);
+    }
     // Move main piece back
-    boardPieces[r1][c1] = *p;
-    p->updateLocation(r1,c1);
-    boardPieces[r2][c2] = Piece();
+    boardPieces[r1][c1] = std::move(boardPieces[r2][c2]);
+    boardPieces[r1][c1].updateLocation(r1,c1);
     // Place back captured piece. NOTE: No need to update captured piece location as it hasn't moved
     if(type == 'E') {
-        // For en passant, the piece needs to be placed one row offset
-        unsigned int i = (p->isWhite) ? -1 : 1;
-        boardPieces[r2 - i][c2] = *lastCapturedPiece;
-    } else if(type == 'C') {
+        // For en passant, the piece needs to be placed beside the original square
+        boardPieces[r2][c2] = Piece();
+        boardPieces[r1][c2] = std::move(u.captured);
+    } else {
+        boardPieces[r2][c2] = std::move(u.captured);
+    }
+    if(type == 'C') {
         // For castle, we need to place back the rook. King has already been placed back above
-        unsigned int rook_c1 = (c2 == 1) ? 0 : 7;
-        unsigned int rook_c2 = (c2 == 1) ? 3 : 5;
-        boardPieces[r1][rook_c1] = boardPieces[r1][rook_c2];
+        unsigned int rook_c1 = (c2 == 2) ? 0 : 7;
+        unsigned int rook_c2 = (c2 == 2) ? 3 : 5;
+        boardPieces[r1][rook_c1] = std::move(boardPieces[r1][rook_c2]);
         boardPieces[r1][rook_c1].updateLocation(r1,rook_c1);
         boardPieces[r1][rook_c2] = Piece();
-    } else if(type == 'X') {
-        boardPieces[r2][c2] = *lastCapturedPiece;
-    }
-}
-
-void Board::trimCheck() {
-    // Remove moves from black which don't escape check
-    if(bitboardHas(blackKing->location.first,blackKing->location.second,whiteAttack)) {
-        // Loop through all moves of black and remove all which don't result in not being in check
-        for(std::list<Piece>::iterator itr = blackPieces.begin(); itr != blackPieces.end(); itr++) {
-            for(std::list<Move>::iterator mitr = itr->moveList.begin(); mitr != itr->moveList.end();) {
-                Move& m = *mitr;
-                forwardMove(m);
-                // Did this fix the check?
-                if(bitboardHas(blackKing->location.first,blackKing->location.second,whiteAttack)) {
-                    mitr = itr->moveList.erase(mitr);
-                } else {
-                    mitr++;
-                }
-                reverseMove(m);
+    }
+    if(boardPieces[r1][c1].pieceType == 'k') {
+        (whiteToMove ? whiteKing : blackKing) = std::make_pair(r1, c1);
+    }
+
+    castleRights = u.castleRights;
+    epColumn = u.epColumn;
+    halfmoveClock = u.halfmoveClock;
+    key = u.key;
+    moveHistory.pop_back();
+    isUpdated = false;
+}
+
+// The null move only flips the side to move. It resets halfmoveClock so repetition checks never look
+// back past it, as positions before and after a null move can't really repeat.
+void Board::forwardNullMove() {
+    Undo u;
+    u.castleRights = castleRights;
+    u.epColumn = epColumn;
+    u.halfmoveClock = halfmoveClock;
+    u.key = key;
+
+    if(epColumn >= 0) {
+        key ^= zobrist.ep[epColumn];
+    }
+    key ^= zobrist.side;
+    epColumn = -1;
+    halfmoveClock = 0;
+    whiteToMove = !whiteToMove;
+    moveHistory.push_back(std::move(u));
+}
+
+void Board::reverseNullMove() {
+    Undo& u = moveHistory.back();
+    whiteToMove = !whiteToMove;
+    epColumn = u.epColumn;
+    halfmoveClock = u.halfmoveClock;
+    key = u.key;
+    moveHistory.pop_back();
+}
+
+// Null move pruning is unsafe in pawn endings, where zugzwang is common
+bool Board::hasNonPawnMaterial(bool isWhite) const {
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = boardPieces[r][c];
+            if(p.isWhite == isWhite && !p.isNull() && p.pieceType != 'p' && p.pieceType != 'k') {
+                return true;
             }
         }
     }
-    // Remove moves from white which don't escape check
-    if(bitboardHas(whiteKing->location.first,whiteKing->location.second,blackAttack)) {
-        // Loop through all moves of white and remove all which don't result in not being in check
-        for(std::list<Piece>::iterator itr = whitePieces.begin(); itr != whitePieces.end(); itr++) {
-            for(std::list<Move>::iterator mitr = itr->moveList.begin(); mitr != itr->moveList.end();) {
-                Move& m = *mitr;
-                forwardMove(m);
-                // Did this fix the check?
-                if(bitboardHas(whiteKing->location.first,whiteKing->location.second,blackAttack)) {
-                    mitr = itr->moveList.erase(mitr);
-                } else {
-                    mitr++;
-                }
-                reverseMove(m);
-            }
+    return false;
+}
+
+bool Board::isCheck(bool isWhite) const {
+    const Square& k = (isWhite) ? whiteKing : blackKing;
+    return isAttacked(k.first,k.second,!isWhite);
+}
+
+// Checks if a move would leave the moving side's own king in check, i.e. whether it is illegal
+bool Board::causesCheck(const Move& m) {
+    bool isWhite = boardPieces[std::get<0>(m).first][std::get<0>(m).second].isWhite;
+    forwardMove(m);
+    bool check = isCheck(isWhite);
+    reverseMove(m);
+    return check;
+}
+
+bool Board::isStalemate(bool isWhite) {
+    if(isWhite != whiteToMove || isCheck(isWhite)) {
+        return false;
+    }
+    std::list<Move> moves;
+    generateLegalMoves(moves);
+    return moves.empty();
+}
+
+bool Board::validMove(const Square& loc1, const Square& loc2) {
+    std::list<Move> moves;
+    generateLegalMoves(moves);
+    for(std::list<Move>::iterator itr = moves.begin(); itr != moves.end(); itr++) {
+        if(std::get<0>(*itr) == loc1 && std::get<1>(*itr) == loc2) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Plays a move for real. Pawns reaching the last row are promoted to a queen.
+bool Board::move(const Square& loc1, const Square& loc2) {
+    std::list<Move> moves;
+    generateLegalMoves(moves);
+    for(std::list<Move>::iterator itr = moves.begin(); itr != moves.end(); itr++) {
+        if(std::get<0>(*itr) == loc1 && std::get<1>(*itr) == loc2) {
+            forwardMove(*itr);
+            isUpdated = false;
+            return true;
         }
     }
+    return false;
 }
 
-// Main move generation function. Updates the moves of all pieces in the board.
+// The attack maps are only needed by front ends, so they are refreshed on demand rather than by every move
 void Board::updateBoard() {
-    // Loop through each piece and call generateMoves
-    for(std::list<Piece>::iterator itr = whitePieces.begin(); itr != whitePieces.end(); itr++) {
-        Piece p = *itr;
-        generateMoves(&p);
-    }
-    for(std::list<Piece>::iterator itr = blackPieces.begin(); itr != blackPieces.end(); itr++) {
-        Piece p = *itr;
-        generateMoves(&p);
-    }
-    // Clear out any moves generated which caused checks
-    trimCheck();
-}
\ No newline at end of file
+    if(isUpdated) {
+        return;
+    }
+    updateAttacks();
+    isUpdated = true;
+}
+
+// MOVE NOTATION
+
+std::string squareToString(const Square& s) {
+    std::string str;
+    str += (char)('a' + s.second);
+    str += (char)('8' - s.first);
+    return str;
+}
+
+std::string moveToString(const Move& m) {
+    std::string str = squareToString(std::get<0>(m)) + squareToString(std::get<1>(m));
+    if(isPromotion(m)) {
+        str += std::get<2>(m);
+    }
+    return str;
+}
+
+// Finds the legal move matching a string in coordinate notation. Returns a null move if there is none.
+Move parseMove(Board& board, const std::string& str) {
+    std::list<Move> moves;
+    board.generateLegalMoves(moves);
+    for(std::list<Move>::iterator itr = moves.begin(); itr != moves.end(); itr++) {
+        if(moveToString(*itr) == str) {
+            return *itr;
+        }
+    }
+    return Move();
+}
@@ -0,0 +1,35 @@
+/*
+ *  CPP Implementation for static evaluation
+ */
+
+#include "evaluate.h"
+#include "eval_weights.h"
+
+int pieceIndex(char type) {
+    switch(type) {
+        case 'p': return 0;
+        case 'n': return 1;
+        case 'b': return 2;
+        case 'r': return 3;
+        case 'q': return 4;
+        case 'k': return 5;
+    }
+    return -1;
+}
+
+// Material plus piece-square bonuses, relative to the side to move. Black pieces read the tables mirrored.
+int evaluate(const Board& board) {
+    int score = 0;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = board.getPiece(r,c);
+            if(p.isNull()) {
+                continue;
+            }
+            int index = pieceIndex(p.pieceType);
+            int value = materialWeights[index] + pieceSquareWeights[index][(p.isWhite) ? r : 7 - r][c];
+            score += (p.isWhite) ? value : -value;
+        }
+    }
+    return (board.isWhiteToMove()) ? score : -score;
+}
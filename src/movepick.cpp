@@ -0,0 +1,133 @@
+/*
+ *  CPP Implementation for the move picker
+ */
+
+#include "movepick.h"
+
+MovePicker::MovePicker(Board& b, MoveList& m, const Move& tt, const Move* k, const int (*h)[64], bool check)
+    : board(b), moves(m), ttMove(tt), killers(k), history(h), inCheck(check), quiescence(false),
+      current(0), killerIndex(0) {
+    // A hash move may come from a different position with the same key, so it has to be checked first
+    if(board.isPseudoLegal(ttMove)) {
+        stage = STAGE_TT_MOVE;
+    } else {
+        ttMove = Move();
+        stage = (inCheck) ? STAGE_EVASIONS_INIT : STAGE_CAPTURES_INIT;
+    }
+}
+
+MovePicker::MovePicker(Board& b, MoveList& m, bool check)
+    : board(b), moves(m), killers(nullptr), history(nullptr), inCheck(check), quiescence(true),
+      current(0), killerIndex(0) {
+    stage = (inCheck) ? STAGE_EVASIONS_INIT : STAGE_CAPTURES_INIT;
+}
+
+// Captures by most valuable victim / least valuable attacker, then queen promotions, then quiet moves by history
+int MovePicker::score(const Move& m) const {
+    const Square& from = std::get<0>(m);
+    const Square& to = std::get<1>(m);
+    int score = 0;
+    if(board.isCapture(m)) {
+        int victim = (std::get<2>(m) == 'E') ? 1 : board.getPiece(to.first,to.second).getPieceValue();
+        int attacker = board.getPiece(from.first,from.second).getPieceValue();
+        score += 2000000 + victim * 10 - attacker;
+    } else if(history) {
+        score += history[from.first * 8 + from.second][to.first * 8 + to.second];
+    }
+    if(std::get<2>(m) == 'q') {
+        score += 1500000;
+    }
+    return score;
+}
+
+void MovePicker::load(bool skipKillers) {
+    int count = 0;
+    for(int i = 0; i < moves.size(); i++) {
+        const Move& m = moves[i];
+        if(m == ttMove || (skipKillers && (m == killers[0] || m == killers[1]))) {
+            continue;
+        }
+        // Quiescence only wants promotions which change the material a lot
+        if(quiescence && !inCheck && isPromotion(m) && std::get<2>(m) != 'q' && !board.isCapture(m)) {
+            continue;
+        }
+        scores[count] = score(m);
+        moves[count++] = m;
+    }
+    moves.count = count;
+    current = 0;
+}
+
+bool MovePicker::pick(Move& m) {
+    if(current == moves.size()) {
+        return false;
+    }
+    int best = current;
+    for(int i = current + 1; i < moves.size(); i++) {
+        if(scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    m = moves[best];
+    // Shift the moves ahead of it along rather than swapping, so the rest stay in generation order
+    for(int i = best; i > current; i--) {
+        moves[i] = moves[i - 1];
+        scores[i] = scores[i - 1];
+    }
+    current++;
+    return true;
+}
+
+Move MovePicker::next() {
+    Move m;
+    while(true) {
+        switch(stage) {
+            case STAGE_TT_MOVE:
+                stage = (inCheck) ? STAGE_EVASIONS_INIT : STAGE_CAPTURES_INIT;
+                return ttMove;
+            case STAGE_CAPTURES_INIT:
+                moves.clear();
+                board.generateCaptures(moves);
+                load(false);
+                stage = STAGE_CAPTURES;
+                break;
+            case STAGE_CAPTURES:
+                if(pick(m)) {
+                    return m;
+                }
+                stage = (quiescence) ? STAGE_DONE : STAGE_KILLERS;
+                break;
+            case STAGE_KILLERS:
+                // Killers were quiet where they cut off, so here they only need to be playable at all
+                while(killers && killerIndex < 2) {
+                    m = killers[killerIndex++];
+                    if(!isNullMove(m) && m != ttMove && board.isPseudoLegal(m)) {
+                        return m;
+                    }
+                }
+                stage = STAGE_QUIETS_INIT;
+                break;
+            case STAGE_QUIETS_INIT:
+                moves.clear();
+                board.generateQuiets(moves);
+                load(killers != nullptr);
+                stage = STAGE_QUIETS;
+                break;
+            case STAGE_EVASIONS_INIT:
+                moves.clear();
+                board.generateEvasions(moves);
+                load(false);
+                stage = STAGE_EVASIONS;
+                break;
+            case STAGE_QUIETS:
+            case STAGE_EVASIONS:
+                if(pick(m)) {
+                    return m;
+                }
+                stage = STAGE_DONE;
+                break;
+            case STAGE_DONE:
+                return Move();
+        }
+    }
+}
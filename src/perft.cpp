@@ -0,0 +1,190 @@
+/*
+ *  CPP Implementation for perft and the move generation consistency checks
+ */
+
+#include "perft.h"
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <vector>
+
+// Published perft counts (chessprogramming.org "Perft Results"), at depths which run in a few seconds
+// with every check enabled
+static const struct {
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+} PERFT_POSITIONS[] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281 },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862 },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+    { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+    { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379 },
+    { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890 },
+};
+
+// Every move code a Move can carry, so isPseudoLegal also sees codes which don't fit the move
+static const char MOVE_CODES[] = { 'N', 'X', 'E', 'C', 'q', 'r', 'b', 'n' };
+
+uint64_t perft(Board& board, int depth) {
+    std::list<Move> moves;
+    board.generateLegalMoves(moves);
+    if(depth <= 1) {
+        return (depth == 1) ? moves.size() : 1;
+    }
+
+    uint64_t nodes = 0;
+    for(const Move& m : moves) {
+        board.forwardMove(m);
+        nodes += perft(board, depth - 1);
+        board.reverseMove(m);
+    }
+    return nodes;
+}
+
+uint64_t perftDivide(Board& board, int depth, std::ostream& out) {
+    std::list<Move> moves;
+    board.generateLegalMoves(moves);
+
+    uint64_t total = 0;
+    for(const Move& m : moves) {
+        board.forwardMove(m);
+        uint64_t nodes = perft(board, depth - 1);
+        board.reverseMove(m);
+        out << moveToString(m) << ": " << nodes << std::endl;
+        total += nodes;
+    }
+    out << std::endl << "Nodes searched: " << total << std::endl;
+    return total;
+}
+
+// Staged generation filtered by causesCheck must give the legal moves, each exactly once
+static bool checkStaged(Board& board, const std::list<Move>& legal) {
+    MoveList staged;
+    if(board.isCheck(board.isWhiteToMove())) {
+        board.generateEvasions(staged);
+    } else {
+        board.generateCaptures(staged);
+        board.generateQuiets(staged);
+    }
+
+    std::vector<Move> got, expected(legal.begin(), legal.end());
+    for(const Move& m : staged) {
+        if(!board.causesCheck(m)) {
+            got.push_back(m);
+        }
+    }
+    std::sort(got.begin(), got.end());
+    std::sort(expected.begin(), expected.end());
+    return got == expected;
+}
+
+// Outside check, generateQuietChecks filtered by causesCheck must give exactly the legal moves which are
+// neither captures, promotions nor castling and which leave the opponent in check
+static bool checkQuietChecks(Board& board, const std::list<Move>& legal) {
+    MoveList generated;
+    board.generateQuietChecks(generated);
+
+    std::vector<Move> got, expected;
+    for(const Move& m : generated) {
+        if(!board.causesCheck(m)) {
+            got.push_back(m);
+        }
+    }
+    for(const Move& m : legal) {
+        if(board.isCapture(m) || isPromotion(m) || std::get<2>(m) == 'C') {
+            continue;
+        }
+        board.forwardMove(m);
+        bool givesCheck = board.isCheck(board.isWhiteToMove());
+        board.reverseMove(m);
+        if(givesCheck) {
+            expected.push_back(m);
+        }
+    }
+    std::sort(got.begin(), got.end());
+    std::sort(expected.begin(), expected.end());
+    return got == expected;
+}
+
+// isPseudoLegal must accept exactly the moves generateMoves produces for the side to move's pieces
+static bool checkPseudoLegal(Board& board, std::ostream& out) {
+    MoveList generated;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = board.getPiece(r, c);
+            if(!p.isNull() && p.isWhite == board.isWhiteToMove()) {
+                board.generateMoves(&p, generated);
+            }
+        }
+    }
+    std::vector<Move> expected(generated.begin(), generated.end());
+    std::sort(expected.begin(), expected.end());
+
+    // Moves from empty or enemy squares are rejected up front, so only own pieces are worth trying
+    for(unsigned int from = 0; from < 64; from++) {
+        const Piece& p = board.getPiece(from / 8, from % 8);
+        if(p.isNull() || p.isWhite != board.isWhiteToMove()) {
+            continue;
+        }
+        for(unsigned int to = 0; to < 64; to++) {
+            for(char code : MOVE_CODES) {
+                Move m = std::make_tuple(Square(from / 8, from % 8), Square(to / 8, to % 8), code);
+                bool accepted = board.isPseudoLegal(m);
+                if(accepted != std::binary_search(expected.begin(), expected.end(), m)) {
+                    out << "isPseudoLegal " << (accepted ? "accepts " : "rejects ") << moveToString(m)
+                        << " (code " << code << ") in " << board.getFen() << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// perft with both checks at every node above the leaves. Stops at the first failure.
+static bool perftChecked(Board& board, int depth, uint64_t& nodes, std::ostream& out) {
+    std::list<Move> moves;
+    board.generateLegalMoves(moves);
+    if(!checkStaged(board, moves)) {
+        out << "Staged generation disagrees with generateLegalMoves in " << board.getFen() << std::endl;
+        return false;
+    }
+    if(!board.isCheck(board.isWhiteToMove()) && !checkQuietChecks(board, moves)) {
+        out << "generateQuietChecks disagrees with the legal quiet checks in " << board.getFen() << std::endl;
+        return false;
+    }
+    if(!checkPseudoLegal(board, out)) {
+        return false;
+    }
+
+    if(depth == 1) {
+        nodes += moves.size();
+        return true;
+    }
+    for(const Move& m : moves) {
+        board.forwardMove(m);
+        bool ok = perftChecked(board, depth - 1, nodes, out);
+        board.reverseMove(m);
+        if(!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runPerftSuite(std::ostream& out) {
+    bool passed = true;
+    auto begin = std::chrono::steady_clock::now();
+    for(const auto& position : PERFT_POSITIONS) {
+        Board board(position.fen);
+        uint64_t nodes = 0;
+        bool ok = perftChecked(board, position.depth, nodes, out) && nodes == position.nodes;
+        out << "perft " << position.depth << " " << nodes << " (expected " << position.nodes << ") "
+            << (ok ? "ok" : "FAILED") << "  " << position.fen << std::endl;
+        passed = passed && ok;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    out << (passed ? "All perft checks passed" : "Perft checks FAILED") << " in " << seconds << "s" << std::endl;
+    return passed;
+}
@@ -0,0 +1,540 @@
+/*
+ *  CPP Implementation for the search
+ */
+
+#include "search.h"
+#include "alloccount.h"
+#include "movepick.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Mate scores are stored relative to the node rather than the root, so they stay correct when the
+// same position is reached at a different ply
+static int scoreToTT(int score, int ply) {
+    if(score > MATE_BOUND) return score + ply;
+    if(score < -MATE_BOUND) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if(score > MATE_BOUND) return score - ply;
+    if(score < -MATE_BOUND) return score + ply;
+    return score;
+}
+
+static unsigned int squareIndex(const Square& s) {
+    return s.first * 8 + s.second;
+}
+
+Search::Search() : stopFlag(false), multiPV(1), out(&std::cout) {
+    setThreads(1);
+}
+
+Search::~Search() {
+    stop();
+}
+
+void Search::newGame() {
+    stop();
+    tt.clear();
+    for(std::unique_ptr<SearchThread>& t : threads) {
+        t->clearHistory();
+    }
+}
+
+void Search::setHashSize(size_t mb) {
+    stop();
+    tt.resize(mb);
+}
+
+void Search::setThreads(int count) {
+    stop();
+    threads.clear();
+    for(int i = 0; i < std::max(1, count); i++) {
+        threads.push_back(std::unique_ptr<SearchThread>(new SearchThread(*this, i)));
+    }
+}
+
+void Search::start(const Board& board, const SearchLimits& l) {
+    stop();
+    limits = l;
+    stopFlag = false;
+    // Keep what was learned on earlier moves, but let it fade
+    tt.newSearch();
+    for(std::unique_ptr<SearchThread>& t : threads) {
+        t->ageHistory();
+    }
+    // The clock starts as soon as the go command arrives, not when the threads get scheduled
+    timeManager.init(limits, board.isWhiteToMove(), board.getPly());
+    // Helpers first: the main thread joins them when it finishes, which may be before a helper started
+    // last would even have been given its thread
+    for(size_t i = threads.size(); i-- > 0;) {
+        threads[i]->start(board);
+    }
+}
+
+void Search::stop() {
+    stopFlag = true;
+    wait();
+}
+
+// The main thread joins the helpers itself before it finishes, so normally only it is left to join
+void Search::wait() {
+    for(std::unique_ptr<SearchThread>& t : threads) {
+        t->join();
+    }
+}
+
+uint64_t Search::getNodes() const {
+    uint64_t total = 0;
+    for(const std::unique_ptr<SearchThread>& t : threads) {
+        total += t->getNodes();
+    }
+    return total;
+}
+
+uint64_t Search::getAllocations() const {
+    uint64_t total = 0;
+    for(const std::unique_ptr<SearchThread>& t : threads) {
+        total += t->allocations;
+    }
+    return total;
+}
+
+void Search::collectStats(SearchStats& total) const {
+    for(const std::unique_ptr<SearchThread>& t : threads) {
+        total.add(t->getStats());
+    }
+}
+
+void Search::resetStats() {
+    for(std::unique_ptr<SearchThread>& t : threads) {
+        t->resetStats();
+    }
+}
+
+// SEARCH THREAD FUNCTIONS START HERE
+
+SearchThread::SearchThread(Search& s, int i)
+    : search(s), id(i), nodes(0), data(new ThreadData), allocations(0), pvIndex(0), bestScore(0) {
+    clearHistory();
+}
+
+void SearchThread::start(const Board& b) {
+    board = b;
+    board.reserveHistory(MAX_PLY);
+    nodes = 0;
+    thread = std::thread(&SearchThread::run, this);
+}
+
+void SearchThread::join() {
+    if(thread.joinable()) {
+        thread.join();
+    }
+}
+
+void SearchThread::clearHistory() {
+    for(unsigned int side = 0; side < 2; side++) {
+        for(unsigned int from = 0; from < 64; from++) {
+            for(unsigned int to = 0; to < 64; to++) {
+                data->history[side][from][to] = 0;
+            }
+        }
+    }
+}
+
+void SearchThread::ageHistory() {
+    for(unsigned int side = 0; side < 2; side++) {
+        for(unsigned int from = 0; from < 64; from++) {
+            for(unsigned int to = 0; to < 64; to++) {
+                data->history[side][from][to] /= 2;
+            }
+        }
+    }
+}
+
+// Called at every node. Only the main thread applies node and time limits. They latch into stopFlag,
+// which also stops the helpers.
+bool SearchThread::checkStop() {
+    if(search.stopFlag.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if(id == 0) {
+        uint64_t n = getNodes();
+        if((search.limits.nodes > 0 && n >= search.limits.nodes) || search.timeManager.outOfTime(n)) {
+            search.stopFlag = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Remembers a quiet move which caused a cutoff, to be tried early in sibling nodes at the same ply
+void SearchThread::updateKillers(const Move& m, int ply) {
+    Move* killers = data->killers[ply];
+    if(killers[0] != m) {
+        killers[1] = killers[0];
+        killers[0] = m;
+    }
+}
+
+// Rewards a quiet move which caused a cutoff. Deeper cutoffs are worth more. Everything is halved if
+// an entry grows large enough to compete with captures.
+void SearchThread::updateHistory(const Move& m, int depth) {
+    int& entry = data->history[board.isWhiteToMove() ? 0 : 1][squareIndex(std::get<0>(m))][squareIndex(std::get<1>(m))];
+    entry += depth * depth;
+    if(entry > 1000000) {
+        ageHistory();
+    }
+}
+
+// Root moves which haven't been ranked yet this iteration. Called once per root move, so a linear scan
+// of a few dozen moves costs nothing next to the search below it.
+RootMove* SearchThread::findRootMove(const Move& m) {
+    for(size_t i = pvIndex; i < rootMoves.size(); i++) {
+        if(rootMoves[i].move == m) {
+            return &rootMoves[i];
+        }
+    }
+    return nullptr;
+}
+
+// The reply we expect to bestMove, used as the ponder move. Taken from the principal variation, or
+// from the hash table when the variation was cut short by a hash hit.
+Move SearchThread::findPonderMove() {
+    if(!rootMoves.empty() && rootMoves[0].pv.size() >= 2) {
+        return rootMoves[0].pv[1];
+    }
+    Move reply;
+    if(isNullMove(bestMove)) {
+        return reply;
+    }
+    board.forwardMove(bestMove);
+    TTEntry entry;
+    if(search.tt.probe(board.getKey(), entry) && board.isPseudoLegal(entry.move) && !board.causesCheck(entry.move)) {
+        reply = entry.move;
+    }
+    board.reverseMove(bestMove);
+    return reply;
+}
+
+void SearchThread::run() {
+    threadStats = &stats;
+    prepare();
+    // The arena and root moves are ready, so nothing from here on should allocate
+    uint64_t allocationsBefore = threadAllocations();
+    iterativeDeepening();
+    allocations = threadAllocations() - allocationsBefore;
+
+    if(id == 0) {
+        // UCI doesn't allow bestmove to be sent during an infinite or ponder search until the GUI says
+        // stop or ponderhit, even if the search has nothing left to do
+        while((search.limits.infinite || search.timeManager.isPondering()) && !search.stopFlag) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // Helpers have no stopping rule of their own
+        search.stopFlag = true;
+        for(size_t i = 1; i < search.threads.size(); i++) {
+            search.threads[i]->join();
+        }
+        if(search.out) {
+            *search.out << "bestmove " << (isNullMove(bestMove) ? "0000" : moveToString(bestMove));
+            if(!isNullMove(ponderMove)) {
+                *search.out << " ponder " << moveToString(ponderMove);
+            }
+            *search.out << std::endl;
+        }
+    }
+    threadStats = nullptr;
+}
+
+// Sets up the root moves and clears the killers, which belong to the previous position
+void SearchThread::prepare() {
+    const SearchLimits& limits = search.limits;
+    std::list<Move> legalMoves;
+    board.generateLegalMoves(legalMoves);
+    rootMoves.clear();
+    for(std::list<Move>::iterator itr = legalMoves.begin(); itr != legalMoves.end(); itr++) {
+        if(limits.searchMoves.empty() || std::find(limits.searchMoves.begin(), limits.searchMoves.end(), *itr) != limits.searchMoves.end()) {
+            rootMoves.push_back(RootMove(*itr));
+        }
+    }
+    for(int ply = 0; ply < MAX_PLY; ply++) {
+        data->killers[ply][0] = data->killers[ply][1] = Move();
+    }
+    // Always have a move to play, even if stopped during the first iteration
+    bestMove = (rootMoves.empty()) ? Move() : rootMoves.front().move;
+    ponderMove = Move();
+    bestScore = 0;
+}
+
+void SearchThread::iterativeDeepening() {
+    const SearchLimits& limits = search.limits;
+    size_t lines = std::min((size_t)search.multiPV, rootMoves.size());
+
+    // Best move of the last completed iteration, for the time manager's stability count
+    Move lastBestMove;
+
+    // Odd helpers start one ply deeper so the threads don't all search the same depth at the same time
+    int maxDepth = (limits.depth > 0 && limits.depth < MAX_PLY) ? limits.depth : MAX_PLY - 1;
+    for(int depth = 1 + (id % 2); depth <= maxDepth && !rootMoves.empty(); depth++) {
+        // Each line gets its own full window search over the moves not ranked yet. The best of them is
+        // moved up to join the lines in front.
+        for(pvIndex = 0; pvIndex < lines; pvIndex++) {
+            int score = alphaBeta(-INFINITE_SCORE, INFINITE_SCORE, depth, 0, false);
+            if(search.stopFlag) {
+                break;
+            }
+            std::vector<RootMove>::iterator best = rootMoves.begin() + pvIndex;
+            while(best->move != data->pvTable[0][0]) {
+                best++;
+            }
+            best->score = score;
+            best->pv.assign(data->pvTable[0], data->pvTable[0] + data->pvLength[0]);
+            std::rotate(rootMoves.begin() + pvIndex, best, best + 1);
+        }
+        // An unfinished iteration can't be trusted, so keep the result of the last complete one
+        if(search.stopFlag) {
+            break;
+        }
+        for(RootMove& rm : rootMoves) {
+            rm.scoreHistory.push_back(rm.score);
+        }
+        bestMove = rootMoves[0].move;
+        bestScore = rootMoves[0].score;
+        if(id != 0) {
+            continue;
+        }
+        ponderMove = findPonderMove();
+        search.printInfo(depth);
+
+        bool bestMoveChanged = bestMove != lastBestMove;
+        lastBestMove = bestMove;
+        if(search.timeManager.iterationDone(bestMoveChanged, bestScore)) {
+            break;
+        }
+        // Nothing more to learn once a forced mate fits inside the searched depth. With several lines the
+        // others still need the full depth.
+        if(!limits.infinite && lines == 1 && std::abs(bestScore) > MATE_BOUND && MATE - std::abs(bestScore) <= depth) {
+            break;
+        }
+    }
+}
+
+int SearchThread::alphaBeta(int alpha, int beta, int depth, int ply, bool allowNull) {
+    data->pvLength[ply] = ply;
+    bool inCheck = board.isCheck(board.isWhiteToMove());
+    // Extend checks so the search doesn't stop in the middle of a forcing sequence
+    if(inCheck) {
+        depth++;
+    }
+    if(depth <= 0) {
+        return quiesce(alpha, beta, ply);
+    }
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    STAT_INC(nodes);
+    if(checkStop()) {
+        return 0;
+    }
+    if(ply > 0 && (board.getHalfmoveClock() >= 100 || board.isRepetition())) {
+        return 0;
+    }
+    if(ply >= MAX_PLY - 1) {
+        return evaluate(board);
+    }
+
+    // A deep enough stored result can answer this node outright. The root always searches so it has a move.
+    TTEntry entry;
+    Move ttMove;
+    STAT_INC(ttProbes);
+    if(search.tt.probe(board.getKey(), entry)) {
+        STAT_INC(ttHits);
+        ttMove = entry.move;
+        int ttScore = scoreFromTT(entry.score, ply);
+        if(ply > 0 && entry.depth >= depth && (entry.bound == BOUND_EXACT ||
+                (entry.bound == BOUND_LOWER && ttScore >= beta) || (entry.bound == BOUND_UPPER && ttScore <= alpha))) {
+            STAT_INC(ttCutoffs);
+            return ttScore;
+        }
+    }
+
+    // Null move pruning: if passing the turn still fails high on a reduced search, a real move will too.
+    // Skipped in check, in pawn endings (zugzwang) and straight after another null move.
+    bool isWhite = board.isWhiteToMove();
+    if(allowNull && !inCheck && depth >= 3 && beta < MATE_BOUND && board.hasNonPawnMaterial(isWhite) && evaluate(board) >= beta) {
+        int reduction = (depth >= 6) ? 3 : 2;
+        STAT_INC(nullMoveTries);
+        board.forwardNullMove();
+        int score = -alphaBeta(-beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+        board.reverseNullMove();
+        if(search.stopFlag) {
+            return 0;
+        }
+        if(score >= beta) {
+            STAT_INC(nullMoveCutoffs);
+            // Don't trust unproven mates from a null move search
+            return (score > MATE_BOUND) ? beta : score;
+        }
+    }
+
+    // Moves come out one category at a time and are only checked for legality when reached, so a
+    // node which cuts off early never generates the rest
+    MovePicker picker(board, data->moves[ply], ttMove, data->killers[ply], data->history[isWhite ? 0 : 1], inCheck);
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove;
+    int moveIndex = 0;
+    for(Move m = picker.next(); !isNullMove(m); m = picker.next()) {
+        // The root only searches moves which are allowed and not already reported this iteration
+        RootMove* rootMove = nullptr;
+        if(ply == 0 && (rootMove = findRootMove(m)) == nullptr) {
+            continue;
+        }
+        if(board.causesCheck(m)) {
+            continue;
+        }
+        uint64_t nodesBefore = (rootMove) ? getNodes() : 0;
+        bool quiet = !board.isCapture(m) && !isPromotion(m);
+        board.forwardMove(m);
+        int score;
+        // Late move reductions: quiet moves ordered late rarely turn out best, so search them shallower
+        // first and only pay for the full depth if they beat alpha
+        if(quiet && moveIndex >= 3 && depth >= 3 && !inCheck && !board.isCheck(!isWhite)) {
+            int reduction = (moveIndex >= 6) ? 2 : 1;
+            STAT_INC(lmrTries);
+            score = -alphaBeta(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1, true);
+            if(score > alpha) {
+                STAT_INC(lmrResearches);
+                score = -alphaBeta(-beta, -alpha, depth - 1, ply + 1, true);
+            }
+        } else {
+            score = -alphaBeta(-beta, -alpha, depth - 1, ply + 1, true);
+        }
+        board.reverseMove(m);
+        if(rootMove) {
+            rootMove->nodes += getNodes() - nodesBefore;
+        }
+        if(search.stopFlag) {
+            return 0;
+        }
+        if(rootMove) {
+            rootMove->score = score;
+        }
+
+        if(score > bestScore) {
+            bestScore = score;
+            if(score > alpha) {
+                alpha = score;
+                bestMove = m;
+                // Extend the principal variation with the child's line
+                data->pvTable[ply][ply] = m;
+                for(int i = ply + 1; i < data->pvLength[ply + 1]; i++) {
+                    data->pvTable[ply][i] = data->pvTable[ply + 1][i];
+                }
+                data->pvLength[ply] = data->pvLength[ply + 1];
+                if(alpha >= beta) {
+                    STAT_INC(betaCutoffs);
+                    STAT_INC(cutoffIndex[std::min(moveIndex, CUTOFF_BUCKETS - 1)]);
+                    if(quiet) {
+                        updateKillers(m, ply);
+                        updateHistory(m, depth);
+                    }
+                    break;
+                }
+            }
+        }
+        moveIndex++;
+    }
+    if(bestScore == -INFINITE_SCORE) {
+        // No legal moves. Checkmate scores prefer the shortest mate, stalemate is a draw
+        return (inCheck) ? -MATE + ply : 0;
+    }
+
+    // A root which left moves out didn't search the whole position, so its result isn't stored
+    if(ply == 0 && (pvIndex > 0 || !search.limits.searchMoves.empty())) {
+        return bestScore;
+    }
+    uint8_t bound = (bestScore >= beta) ? BOUND_LOWER : (alpha > originalAlpha) ? BOUND_EXACT : BOUND_UPPER;
+    search.tt.store(board.getKey(), bestMove, scoreToTT(bestScore, ply), depth, bound);
+    return bestScore;
+}
+
+// Searches captures until the position is quiet, so the static evaluation isn't taken in the middle of
+// an exchange. A side in check can't stand pat, so it searches every evasion instead. Quiet checks were
+// tried at the first ply (Board::generateQuietChecks) but doubled the tree for no measurable gain.
+int SearchThread::quiesce(int alpha, int beta, int ply) {
+    data->pvLength[ply] = ply;
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    STAT_INC(nodes);
+    STAT_INC(qnodes);
+    if(checkStop()) {
+        return 0;
+    }
+    bool inCheck = board.isCheck(board.isWhiteToMove());
+    if(ply >= MAX_PLY - 1) {
+        return evaluate(board);
+    }
+    int bestScore = -MATE + ply;
+    if(!inCheck) {
+        bestScore = evaluate(board);
+        if(bestScore >= beta) {
+            return bestScore;
+        }
+        if(bestScore > alpha) {
+            alpha = bestScore;
+        }
+    }
+
+    MovePicker picker(board, data->moves[ply], inCheck);
+    for(Move m = picker.next(); !isNullMove(m); m = picker.next()) {
+        if(board.causesCheck(m)) {
+            continue;
+        }
+        board.forwardMove(m);
+        int score = -quiesce(-beta, -alpha, ply + 1);
+        board.reverseMove(m);
+        if(search.stopFlag) {
+            return 0;
+        }
+        if(score > bestScore) {
+            bestScore = score;
+            if(score > alpha) {
+                alpha = score;
+                if(alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+    return bestScore;
+}
+
+// Reports a completed iteration in UCI info format, one line per best move found
+void Search::printInfo(int depth) {
+    if(!out) {
+        return;
+    }
+    const SearchThread& main = *threads[0];
+    uint64_t nodes = getNodes();
+    int64_t time = timeManager.searchElapsed();
+    size_t lines = std::min((size_t)multiPV, main.rootMoves.size());
+    for(size_t line = 0; line < lines; line++) {
+        const RootMove& rm = main.rootMoves[line];
+        *out << "info depth " << depth << " multipv " << line + 1 << " score ";
+        if(rm.score > MATE_BOUND) {
+            *out << "mate " << (MATE - rm.score + 1) / 2;
+        } else if(rm.score < -MATE_BOUND) {
+            *out << "mate " << -(MATE + rm.score) / 2;
+        } else {
+            *out << "cp " << rm.score;
+        }
+        *out << " nodes " << nodes << " nps " << nodes * 1000 / (time + 1) << " hashfull " << tt.hashfull()
+             << " time " << time << " pv";
+        for(const Move& m : rm.pv) {
+            *out << " " << moveToString(m);
+        }
+        *out << std::endl;
+    }
+}
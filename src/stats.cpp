@@ -0,0 +1,79 @@
+/*
+ *  CPP Implementation for search statistics
+ */
+
+#include "stats.h"
+#include <sstream>
+
+thread_local SearchStats* threadStats = nullptr;
+
+void SearchStats::reset() {
+    nodes.reset();
+    qnodes.reset();
+    ttProbes.reset();
+    ttHits.reset();
+    ttCutoffs.reset();
+    betaCutoffs.reset();
+    for(int i = 0; i < CUTOFF_BUCKETS; i++) {
+        cutoffIndex[i].reset();
+    }
+    nullMoveTries.reset();
+    nullMoveCutoffs.reset();
+    lmrTries.reset();
+    lmrResearches.reset();
+    for(int i = 0; i < 6; i++) {
+        movegen[i].reset();
+    }
+}
+
+void SearchStats::add(const SearchStats& other) {
+    nodes.inc(other.nodes.get());
+    qnodes.inc(other.qnodes.get());
+    ttProbes.inc(other.ttProbes.get());
+    ttHits.inc(other.ttHits.get());
+    ttCutoffs.inc(other.ttCutoffs.get());
+    betaCutoffs.inc(other.betaCutoffs.get());
+    for(int i = 0; i < CUTOFF_BUCKETS; i++) {
+        cutoffIndex[i].inc(other.cutoffIndex[i].get());
+    }
+    nullMoveTries.inc(other.nullMoveTries.get());
+    nullMoveCutoffs.inc(other.nullMoveCutoffs.get());
+    lmrTries.inc(other.lmrTries.get());
+    lmrResearches.inc(other.lmrResearches.get());
+    for(int i = 0; i < 6; i++) {
+        movegen[i].inc(other.movegen[i].get());
+    }
+}
+
+static double ratio(uint64_t part, uint64_t whole) {
+    return (whole == 0) ? 0.0 : (double)part / whole;
+}
+
+std::string SearchStats::toJson(int threads) const {
+    std::ostringstream ss;
+#ifdef CHESS_STATS
+    ss << "{\"enabled\":true,\"threads\":" << threads;
+#else
+    ss << "{\"enabled\":false,\"threads\":" << threads;
+#endif
+    ss << ",\"nodes\":" << nodes.get() << ",\"qnodes\":" << qnodes.get();
+    ss << ",\"tt\":{\"probes\":" << ttProbes.get() << ",\"hits\":" << ttHits.get() << ",\"cutoffs\":" << ttCutoffs.get()
+       << ",\"hitRate\":" << ratio(ttHits.get(), ttProbes.get()) << "}";
+    ss << ",\"betaCutoffs\":{\"total\":" << betaCutoffs.get()
+       << ",\"firstMoveRate\":" << ratio(cutoffIndex[0].get(), betaCutoffs.get()) << ",\"byIndex\":[";
+    for(int i = 0; i < CUTOFF_BUCKETS; i++) {
+        ss << (i > 0 ? "," : "") << cutoffIndex[i].get();
+    }
+    ss << "]}";
+    ss << ",\"nullMove\":{\"tries\":" << nullMoveTries.get() << ",\"cutoffs\":" << nullMoveCutoffs.get()
+       << ",\"successRate\":" << ratio(nullMoveCutoffs.get(), nullMoveTries.get()) << "}";
+    ss << ",\"lmr\":{\"tries\":" << lmrTries.get() << ",\"researches\":" << lmrResearches.get()
+       << ",\"successRate\":" << ratio(lmrTries.get() - lmrResearches.get(), lmrTries.get()) << "}";
+    static const char* pieceNames[6] = {"pawn", "knight", "bishop", "rook", "queen", "king"};
+    ss << ",\"movegen\":{";
+    for(int i = 0; i < 6; i++) {
+        ss << (i > 0 ? "," : "") << "\"" << pieceNames[i] << "\":" << movegen[i].get();
+    }
+    ss << "}}";
+    return ss.str();
+}
@@ -0,0 +1,110 @@
+/*
+ *  CPP Implementation for time management
+ */
+
+#include "timeman.h"
+#include <algorithm>
+#include "search.h"
+
+// Soft limit multiplier by the number of iterations in a row the best move has stayed the same.
+// A move that just changed gets extra time, one that has held for many iterations gets less.
+static const double stabilityScale[5] = {1.6, 1.25, 1.0, 0.85, 0.7};
+
+TimeManager::TimeManager() : startTime(now()), searchStartTime(now()), pondering(false), timeControlled(false), moveOverhead(30), optimumTime(0), softLimit(0), hardLimit(0),
+    stability(0), lastScore(0), hasScore(false), nextCheck(CHECK_INTERVAL), hardStop(false) {}
+
+int64_t TimeManager::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t TimeManager::elapsed() const {
+    return now() - startTime;
+}
+
+int64_t TimeManager::searchElapsed() const {
+    return now() - searchStartTime;
+}
+
+void TimeManager::ponderhit() {
+    startTime = now();
+    pondering = false;
+}
+
+void TimeManager::init(const SearchLimits& limits, bool isWhite, int ply) {
+    startTime = searchStartTime = now();
+    pondering = limits.ponder;
+    stability = 0;
+    lastScore = 0;
+    hasScore = false;
+    nextCheck = CHECK_INTERVAL;
+    hardStop = false;
+
+    int64_t time = (isWhite) ? limits.wtime : limits.btime;
+    int64_t inc = (isWhite) ? limits.winc : limits.binc;
+    bool hasTime = (isWhite) ? limits.hasWtime : limits.hasBtime;
+
+    // A fixed time per move is a hard limit only
+    if(limits.movetime >= 0) {
+        timeControlled = true;
+        optimumTime = softLimit = hardLimit = std::max<int64_t>(1, limits.movetime - moveOverhead);
+        return;
+    }
+    // Infinite, depth and node searches run until stopped or the limit is reached
+    if(limits.infinite || !hasTime) {
+        timeControlled = false;
+        optimumTime = softLimit = hardLimit = 0;
+        return;
+    }
+
+    timeControlled = true;
+    // Overdrawn, or too little left to cover the overhead: move at once, spending only part of the increment
+    if(time <= moveOverhead) {
+        optimumTime = softLimit = hardLimit = std::max<int64_t>(1, time - moveOverhead) + inc / 4;
+        return;
+    }
+    // Always keep the move overhead in hand so lag can't flag us
+    int64_t available = std::max<int64_t>(1, time - moveOverhead);
+    // Moves still to be played this time control. Without movestogo assume the game gets shorter as it goes on.
+    int movesLeft = (limits.movestogo > 0) ? std::min(limits.movestogo, 50) : std::max(20, 50 - ply / 4);
+
+    optimumTime = available / movesLeft + inc * 3 / 4;
+    if(movesLeft == 1) {
+        // Last move before the time control: use most of what is left
+        optimumTime = std::min(optimumTime, available * 8 / 10);
+        hardLimit = available * 9 / 10;
+    } else {
+        // Never plan to spend more than half the clock on one move, nor let an unstable search
+        // run past five times its budget
+        optimumTime = std::min(optimumTime, available / 2);
+        hardLimit = std::min(optimumTime * 5, available * 8 / 10);
+    }
+    optimumTime = std::max<int64_t>(1, optimumTime);
+    hardLimit = std::max(hardLimit, optimumTime);
+    softLimit = optimumTime;
+}
+
+bool TimeManager::iterationDone(bool bestMoveChanged, int score) {
+    if(!timeControlled) {
+        return false;
+    }
+
+    if(!bestMoveChanged) {
+        stability = std::min(stability + 1, 4);
+    } else {
+        stability = 0;
+    }
+
+    // A falling score means the search found a problem, so give it up to twice the time to find an
+    // answer. A rising score trims a little off.
+    double scoreScale = 1.0;
+    if(hasScore) {
+        int drop = lastScore - score;
+        scoreScale = std::min(2.0, std::max(0.8, 1.0 + drop / 100.0));
+    }
+    lastScore = score;
+    hasScore = true;
+
+    softLimit = std::min<int64_t>(hardLimit, (int64_t)(optimumTime * stabilityScale[stability] * scoreScale));
+    // While pondering the clock isn't ours yet, so keep deepening until ponderhit or stop
+    return !pondering && elapsed() >= softLimit;
+}
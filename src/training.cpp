@@ -0,0 +1,168 @@
+/*
+ *  CPP Implementation for training data
+ */
+
+#include "training.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHESS_HAVE_MMAP
+#endif
+
+// Every file starts with this, so readers can reject anything else or an older layout
+struct TrainingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+static const char TRAINING_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'T', 'R', 'N'};
+static const uint32_t TRAINING_VERSION = 1;
+
+// Move codes in the order they're packed
+static const char moveCodes[] = "NXECqrbn";
+
+uint16_t packMove(const Move& m) {
+    if(isNullMove(m)) {
+        return 0;
+    }
+    const Square& from = std::get<0>(m);
+    const Square& to = std::get<1>(m);
+    const char* code = std::strchr(moveCodes, std::get<2>(m));
+    unsigned int type = (code) ? code - moveCodes : 0;
+    return (uint16_t)((from.first * 8 + from.second) | ((to.first * 8 + to.second) << 6) | (type << 12));
+}
+
+Move unpackMove(uint16_t packed) {
+    if(packed == 0) {
+        return Move();
+    }
+    unsigned int from = packed & 63, to = (packed >> 6) & 63, type = (packed >> 12) & 7;
+    return std::make_tuple(std::make_pair(from / 8, from % 8), std::make_pair(to / 8, to % 8), moveCodes[type]);
+}
+
+TrainingRecord makeRecord(const Board& board, int score, const Move& best, int result) {
+    TrainingRecord record;
+    board.pack(record.position);
+    record.score = (int16_t)std::max(-32767, std::min(32767, score));
+    record.move = packMove(best);
+    record.ply = (uint16_t)std::min(board.getPly(), 65535);
+    record.result = (int8_t)result;
+    record.reserved = 0;
+    return record;
+}
+
+// WRITER
+
+bool TrainingWriter::open(const std::string& path, bool append) {
+    close();
+    file = std::fopen(path.c_str(), append ? "ab" : "wb");
+    if(!file) {
+        return false;
+    }
+    // An empty file, new or appended to, needs the header first
+    std::fseek(file, 0, SEEK_END);
+    if(std::ftell(file) == 0) {
+        TrainingHeader header;
+        std::memcpy(header.magic, TRAINING_MAGIC, sizeof(header.magic));
+        header.version = TRAINING_VERSION;
+        header.recordSize = sizeof(TrainingRecord);
+        std::fwrite(&header, sizeof(header), 1, file);
+    }
+    buffer.reserve(BUFFER_RECORDS);
+    written = 0;
+    return true;
+}
+
+void TrainingWriter::write(const TrainingRecord& record) {
+    buffer.push_back(record);
+    if(buffer.size() >= BUFFER_RECORDS) {
+        flush();
+    }
+}
+
+void TrainingWriter::flush() {
+    if(file && !buffer.empty()) {
+        written += std::fwrite(buffer.data(), sizeof(TrainingRecord), buffer.size(), file);
+        std::fflush(file);
+    }
+    buffer.clear();
+}
+
+void TrainingWriter::close() {
+    if(file) {
+        flush();
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+// READER
+
+bool TrainingReader::open(const std::string& path) {
+    close();
+#ifdef CHESS_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TrainingHeader)) {
+        ::close(fd);
+        return false;
+    }
+    mappedSize = info.st_size;
+    data = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file
+    ::close(fd);
+    if(data == MAP_FAILED) {
+        data = nullptr;
+        mappedSize = 0;
+        return false;
+    }
+    madvise(data, mappedSize, MADV_SEQUENTIAL);
+#else
+    std::ifstream in(path, std::ios::binary);
+    fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if(fallback.size() < sizeof(TrainingHeader)) {
+        fallback.clear();
+        return false;
+    }
+    data = fallback.data();
+    mappedSize = fallback.size();
+#endif
+
+    const TrainingHeader* header = (const TrainingHeader*)data;
+    if(std::memcmp(header->magic, TRAINING_MAGIC, sizeof(header->magic)) != 0 || header->version != TRAINING_VERSION ||
+            header->recordSize != sizeof(TrainingRecord)) {
+        close();
+        return false;
+    }
+    // The header is 16 bytes, so records stay 8-byte aligned within the page-aligned mapping
+    records = (const TrainingRecord*)((const char*)data + sizeof(TrainingHeader));
+    count = (mappedSize - sizeof(TrainingHeader)) / sizeof(TrainingRecord);
+    return true;
+}
+
+void TrainingReader::close() {
+#ifdef CHESS_HAVE_MMAP
+    if(data) {
+        munmap(data, mappedSize);
+    }
+#endif
+    fallback.clear();
+    data = nullptr;
+    mappedSize = 0;
+    records = nullptr;
+    count = 0;
+}
+
+void TrainingReader::shard(int index, int shards, const TrainingRecord*& first, const TrainingRecord*& last) const {
+    first = records + count * index / shards;
+    last = records + count * (index + 1) / shards;
+}
@@ -0,0 +1,77 @@
+/*
+ *  CPP Implementation for the transposition table
+ */
+
+#include "tt.h"
+#include "training.h"
+
+// Packed entry layout: move (16 bits), score (16), depth (8), bound (8), generation (8)
+static uint64_t packEntry(const Move& move, int score, int depth, uint8_t bound, uint8_t generation) {
+    return (uint64_t)packMove(move) | ((uint64_t)(uint16_t)score << 16) | ((uint64_t)(uint8_t)depth << 32) |
+           ((uint64_t)bound << 40) | ((uint64_t)generation << 48);
+}
+
+static uint8_t entryBound(uint64_t data) { return (data >> 40) & 0xFF; }
+static uint8_t entryGeneration(uint64_t data) { return (data >> 48) & 0xFF; }
+
+TranspositionTable::TranspositionTable() : size(0), generation(0) {
+    resize(16);
+}
+
+void TranspositionTable::resize(size_t mb) {
+    size_t entries = mb * 1024 * 1024 / sizeof(Slot);
+    size = (entries > 0) ? entries : 1;
+    table.reset(new Slot[size]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for(size_t i = 0; i < size; i++) {
+        table[i].check.store(0, std::memory_order_relaxed);
+        table[i].data.store(0, std::memory_order_relaxed);
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Slot& slot = table[key % size];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if(entryBound(data) == BOUND_NONE || (slot.check.load(std::memory_order_relaxed) ^ data) != key) {
+        return false;
+    }
+    entry.key = key;
+    entry.move = unpackMove(data & 0xFFFF);
+    entry.score = (int16_t)((data >> 16) & 0xFFFF);
+    entry.depth = (int8_t)((data >> 32) & 0xFF);
+    entry.bound = entryBound(data);
+    entry.generation = entryGeneration(data);
+    return true;
+}
+
+// Replacement: always take over an entry from an older search or for the same position, otherwise
+// only replace shallower results
+void TranspositionTable::store(uint64_t key, const Move& move, int score, int depth, uint8_t bound) {
+    Slot& slot = table[key % size];
+    uint64_t old = slot.data.load(std::memory_order_relaxed);
+    bool sameKey = (slot.check.load(std::memory_order_relaxed) ^ old) == key;
+    if(entryBound(old) != BOUND_NONE && entryGeneration(old) == generation && !sameKey && (int8_t)((old >> 32) & 0xFF) > depth) {
+        return;
+    }
+    // Keep the old move if this result didn't find one, it is still the best guess for ordering
+    Move best = (sameKey && std::get<2>(move) == '\0') ? unpackMove(old & 0xFFFF) : move;
+    uint64_t data = packEntry(best, score, depth, bound, generation);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t samples = (size < 1000) ? size : 1000;
+    int used = 0;
+    for(size_t i = 0; i < samples; i++) {
+        uint64_t data = table[i].data.load(std::memory_order_relaxed);
+        if(entryBound(data) != BOUND_NONE && entryGeneration(data) == generation) {
+            used++;
+        }
+    }
+    return used * 1000 / samples;
+}
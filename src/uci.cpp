@@ -0,0 +1,199 @@
+/*
+ *  CPP Implementation for the UCI front end
+ */
+
+#include "uci.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "bench.h"
+#include "board.h"
+#include "perft.h"
+#include "search.h"
+
+// position [startpos | fen <fen>] [moves <move> ...]
+static void parsePosition(Board& board, std::istringstream& ss) {
+    std::string token, fen;
+    ss >> token;
+    if(token == "startpos") {
+        fen = START_FEN;
+        ss >> token;
+    } else if(token == "fen") {
+        while(ss >> token && token != "moves") {
+            fen += token + " ";
+        }
+    } else {
+        return;
+    }
+    board.setFen(fen);
+    // Remaining tokens (after "moves") are played in order
+    while(ss >> token) {
+        Move m = parseMove(board, token);
+        if(isNullMove(m)) {
+            break;
+        }
+        board.forwardMove(m);
+    }
+}
+
+// go [ponder] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [movetime <ms>] [depth <n>] [nodes <n>] [infinite]
+//    [searchmoves <move> ...]
+static SearchLimits parseGo(Board& board, std::istringstream& ss) {
+    SearchLimits limits;
+    std::string token;
+    bool readingMoves = false;
+    while(ss >> token) {
+        if(token == "wtime") limits.hasWtime = (bool)(ss >> limits.wtime);
+        else if(token == "btime") limits.hasBtime = (bool)(ss >> limits.btime);
+        else if(token == "winc") ss >> limits.winc;
+        else if(token == "binc") ss >> limits.binc;
+        else if(token == "movestogo") ss >> limits.movestogo;
+        else if(token == "movetime") ss >> limits.movetime;
+        else if(token == "depth") ss >> limits.depth;
+        else if(token == "nodes") ss >> limits.nodes;
+        else if(token == "infinite") limits.infinite = true;
+        else if(token == "ponder") limits.ponder = true;
+        else if(token == "searchmoves") readingMoves = true;
+        // Moves listed after searchmoves. Illegal ones are dropped.
+        else if(readingMoves) {
+            Move m = parseMove(board, token);
+            if(!isNullMove(m)) {
+                limits.searchMoves.push_back(m);
+            } else {
+                std::cout << "info string searchmoves: " << token << " is not a legal move" << std::endl;
+            }
+        }
+    }
+    // An empty list means no restriction, so say so rather than quietly searching every move
+    if(readingMoves && limits.searchMoves.empty()) {
+        std::cout << "info string searchmoves: no legal moves given, searching all moves" << std::endl;
+    }
+    return limits;
+}
+
+// Reads a spin option's value clamped to [min, max]. A missing or non-numeric value leaves the option as it
+// was and returns false.
+static bool parseSpin(const std::string& name, const std::string& value, int min, int max, int& result) {
+    try {
+        result = (int)std::clamp<long long>(std::stoll(value), min, max);
+        return true;
+    } catch(const std::logic_error&) {
+        std::cout << "info string " << name << ": invalid value \"" << value << "\", ignored" << std::endl;
+        return false;
+    }
+}
+
+// setoption name <id> value <x>
+static void parseOption(Search& search, std::istringstream& ss) {
+    std::string token, name, value;
+    ss >> token;
+    while(ss >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    ss >> value;
+    int n;
+    if(name == "Move Overhead" && parseSpin(name, value, 0, 5000, n)) {
+        search.setMoveOverhead(n);
+    } else if(name == "Hash" && parseSpin(name, value, 1, 65536, n)) {
+        search.setHashSize(n);
+    } else if(name == "Threads" && parseSpin(name, value, 1, 256, n)) {
+        search.setThreads(n);
+    } else if(name == "MultiPV" && parseSpin(name, value, 1, 256, n)) {
+        search.setMultiPV(n);
+    }
+    // Ponder needs no handling. It only tells us the GUI may send "go ponder".
+}
+
+// bench [depth] [threads] [hash]
+static void parseBench(std::istringstream& ss) {
+    int depth = BENCH_DEFAULT_DEPTH, threads = 1, hash = 16;
+    ss >> depth >> threads >> hash;
+    runBench(depth, threads, hash);
+}
+
+// perft [depth]. With a depth, prints the divide counts from board; without one, runs the reference
+// suite with the move generation consistency checks and reports whether it passed.
+static bool parsePerft(Board& board, std::istringstream& ss) {
+    int depth = 0;
+    if(ss >> depth && depth > 0) {
+        perftDivide(board, depth, std::cout);
+        return true;
+    }
+    return runPerftSuite(std::cout);
+}
+
+int uciLoop(int argc, char* argv[]) {
+    Board board;
+    Search search;
+    std::string line, command;
+
+    // Arguments on the command line are run as a single command, e.g. "chess-uci bench 8 1 16"
+    if(argc > 1) {
+        for(int i = 1; i < argc; i++) {
+            line += std::string(argv[i]) + " ";
+        }
+        std::istringstream ss(line);
+        ss >> command;
+        if(command == "bench") {
+            parseBench(ss);
+        } else if(command == "perft") {
+            return parsePerft(board, ss) ? 0 : 1;
+        }
+        return 0;
+    }
+
+    while(std::getline(std::cin, line)) {
+        std::istringstream ss(line);
+        command.clear();
+        ss >> command;
+
+        if(command == "uci") {
+            std::cout << "id name Chess-Engine" << std::endl;
+            std::cout << "id author Aidan Westphal" << std::endl;
+            std::cout << "option name Hash type spin default 16 min 1 max 65536" << std::endl;
+            std::cout << "option name Ponder type check default false" << std::endl;
+            std::cout << "option name Threads type spin default 1 min 1 max 256" << std::endl;
+            std::cout << "option name MultiPV type spin default 1 min 1 max 256" << std::endl;
+            std::cout << "option name Move Overhead type spin default 30 min 0 max 5000" << std::endl;
+            std::cout << "uciok" << std::endl;
+        } else if(command == "isready") {
+            std::cout << "readyok" << std::endl;
+        } else if(command == "setoption") {
+            parseOption(search, ss);
+        } else if(command == "ucinewgame") {
+            search.newGame();
+            board = Board();
+        } else if(command == "position") {
+            parsePosition(board, ss);
+        } else if(command == "go") {
+            search.start(board, parseGo(board, ss));
+        } else if(command == "ponderhit") {
+            search.ponderhit();
+        } else if(command == "stop") {
+            search.stop();
+        } else if(command == "quit") {
+            break;
+        } else if(command == "d") {
+            std::cout << board.getFen() << std::endl;
+        } else if(command == "stats") {
+            // Debug command: "stats" dumps the search counters as JSON, "stats reset" clears them
+            std::string arg;
+            ss >> arg;
+            if(arg == "reset") {
+                search.resetStats();
+            } else {
+                SearchStats total;
+                search.collectStats(total);
+                std::cout << total.toJson(search.getThreads()) << std::endl;
+            }
+        } else if(command == "bench") {
+            parseBench(ss);
+        } else if(command == "perft") {
+            parsePerft(board, ss);
+        }
+    }
+    search.stop();
+    return 0;
+}
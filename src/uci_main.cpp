@@ -0,0 +1,9 @@
+/*
+ *  Entry point for the UCI engine. The wxWidgets application in main.cpp is the graphical front end.
+ */
+
+#include "uci.h"
+
+int main(int argc, char* argv[]) {
+    return uciLoop(argc, argv);
+}
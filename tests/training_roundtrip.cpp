@@ -0,0 +1,156 @@
+/*
+ *  Round-trip test for training data. Every position within two plies of the bench/positions.fen corpus is
+ * packed and unpacked, then written as a record with TrainingWriter and read back with TrainingReader,
+ * and must come back identical: FEN, Zobrist key, side to move, castling, en passant and the record fields.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "training.h"
+
+// What a record must read back as, taken from the board it was made from
+struct Expected {
+    std::string fen;
+    uint64_t key;
+    bool whiteToMove;
+    unsigned char castleRights;
+    int epColumn;
+    int score;
+    Move move;
+    int ply;
+    int result;
+};
+
+static int failures = 0;
+
+static void fail(const std::string& what, const std::string& fen) {
+    if(failures++ < 20) {
+        std::cout << what << " differs after the round trip: " << fen << std::endl;
+    }
+}
+
+// Compares a board rebuilt from a packed position against the original's state
+static void checkBoard(const Board& board, const Expected& e) {
+    if(board.getFen() != e.fen) {
+        fail("FEN (got " + board.getFen() + ")", e.fen);
+    }
+    if(board.getKey() != e.key || board.computeKey() != e.key) {
+        fail("Zobrist key", e.fen);
+    }
+    if(board.isWhiteToMove() != e.whiteToMove) {
+        fail("Side to move", e.fen);
+    }
+    if(board.getCastleRights() != e.castleRights) {
+        fail("Castling rights", e.fen);
+    }
+    if(board.getEpColumn() != e.epColumn) {
+        fail("En passant column", e.fen);
+    }
+}
+
+// Records every node up to depth plies below board, packing and unpacking each one on the way
+static void collect(Board& board, int depth, std::vector<TrainingRecord>& records, std::vector<Expected>& expected) {
+    std::list<Move> moves;
+    board.generateLegalMoves(moves);
+
+    // Spread scores and results over their whole range, clamped extremes included
+    int n = (int)records.size();
+    Expected e = {board.getFen(), board.getKey(), board.isWhiteToMove(), board.getCastleRights(), board.getEpColumn(),
+                  (n % 7 == 0) ? 40000 - 80000 * (n % 2) : n % 4001 - 2000,
+                  moves.empty() ? Move() : moves.back(), board.getPly(), n % 3 - 1};
+    records.push_back(makeRecord(board, e.score, e.move, e.result));
+    e.score = std::max(-32767, std::min(32767, e.score));
+    expected.push_back(e);
+
+    Board unpacked;
+    if(!unpacked.unpack(records.back().position)) {
+        fail("unpack failed,", e.fen);
+    } else {
+        checkBoard(unpacked, e);
+    }
+
+    if(depth == 0) {
+        return;
+    }
+    for(const Move& m : moves) {
+        board.forwardMove(m);
+        collect(board, depth - 1, records, expected);
+        board.reverseMove(m);
+    }
+}
+
+int main() {
+    std::vector<TrainingRecord> records;
+    std::vector<Expected> expected;
+    std::ifstream in(CHESS_BENCH_POSITIONS);
+    std::string line;
+    while(std::getline(in, line)) {
+        if(!line.empty()) {
+            Board board(line);
+            collect(board, 2, records, expected);
+        }
+    }
+    if(records.empty()) {
+        std::cout << "No positions read from " << CHESS_BENCH_POSITIONS << std::endl;
+        return 1;
+    }
+
+    // Written in two sessions so appending to an existing file is covered too
+    const std::string path = "training_roundtrip.bin";
+    std::remove(path.c_str());
+    TrainingWriter writer;
+    size_t half = records.size() / 2;
+    for(int session = 0; session < 2; session++) {
+        if(!writer.open(path, session == 1)) {
+            std::cout << "Could not open " << path << " for writing" << std::endl;
+            return 1;
+        }
+        for(size_t i = (session == 0) ? 0 : half; i < ((session == 0) ? half : records.size()); i++) {
+            writer.write(records[i]);
+        }
+        writer.close();
+    }
+
+    TrainingReader reader;
+    if(!reader.open(path)) {
+        std::cout << "Could not read back " << path << std::endl;
+        return 1;
+    }
+    if(reader.size() != records.size()) {
+        std::cout << "Read " << reader.size() << " records, wrote " << records.size() << std::endl;
+        return 1;
+    }
+    for(size_t i = 0; i < reader.size(); i++) {
+        const TrainingRecord& r = reader[i];
+        const Expected& e = expected[i];
+        if(r.score != e.score) {
+            fail("Score", e.fen);
+        }
+        if(unpackMove(r.move) != e.move) {
+            fail("Move " + moveToString(e.move), e.fen);
+        }
+        if(r.ply != e.ply) {
+            fail("Ply", e.fen);
+        }
+        if(r.result != e.result) {
+            fail("Result", e.fen);
+        }
+        Board board;
+        if(!board.unpack(r.position)) {
+            fail("unpack of the read record failed,", e.fen);
+        } else {
+            checkBoard(board, e);
+        }
+    }
+    reader.close();
+    std::remove(path.c_str());
+
+    std::cout << records.size() << " positions, " << failures << " failures" << std::endl;
+    return (failures == 0) ? 0 : 1;
+}
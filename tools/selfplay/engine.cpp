@@ -0,0 +1,326 @@
+/*
+ *  CPP Implementation for the engines played by selfplay
+ */
+
+#include "engine.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "board.h"
+#include "evaluate.h"
+#include "search.h"
+
+// The core library searching on its own threads inside this process
+class InProcessEngine : public Engine {
+    public:
+    InProcessEngine(const EngineConfig& config);
+
+    bool newGame();
+    std::string go(const std::string& fen, const std::vector<std::string>& moves, const SearchLimits& limits,
+                   int64_t timeLimit, int& score);
+
+    private:
+    Search search;
+};
+
+InProcessEngine::InProcessEngine(const EngineConfig& config) {
+    search.setOutput(nullptr);
+    // Same names as the UCI options so a configuration can be moved between the two kinds of engine
+    for(const std::pair<std::string, std::string>& option : config.options) {
+        if(option.first == "Hash") {
+            search.setHashSize(std::stoi(option.second));
+        } else if(option.first == "Threads") {
+            search.setThreads(std::stoi(option.second));
+        } else if(option.first == "Move Overhead") {
+            search.setMoveOverhead(std::stoi(option.second));
+        } else {
+            std::cerr << config.name << ": ignoring unknown option " << option.first << std::endl;
+        }
+    }
+}
+
+bool InProcessEngine::newGame() {
+    search.newGame();
+    return true;
+}
+
+// The search keeps to its own clock, so timeLimit isn't needed here
+std::string InProcessEngine::go(const std::string& fen, const std::vector<std::string>& moves, const SearchLimits& limits,
+                                int64_t, int& score) {
+    // Replayed rather than set from the current FEN so the search sees the game history for repetitions
+    Board board(fen);
+    for(const std::string& m : moves) {
+        board.forwardMove(parseMove(board, m));
+    }
+    search.start(board, limits);
+    search.wait();
+    score = search.getScore();
+    return isNullMove(search.getBestMove()) ? "" : moveToString(search.getBestMove());
+}
+
+// Longest wait for uciok and readyok before an engine counts as hung
+static const int64_t HANDSHAKE_TIMEOUT = 10000;
+
+typedef std::chrono::steady_clock::time_point Deadline;
+
+// A UCI engine run as a child process. Each game in progress needs its own instance. Every read has a deadline, so a
+// hung engine is killed instead of stalling its worker, and is started again for the next game.
+class UciEngine : public Engine {
+    public:
+    UciEngine(const EngineConfig& c) : config(c), pid(-1), in(nullptr), outFd(-1) {}
+    ~UciEngine();
+
+    bool launch();
+    bool newGame();
+    std::string go(const std::string& fen, const std::vector<std::string>& moves, const SearchLimits& limits,
+                   int64_t timeLimit, int& score);
+
+    private:
+    void send(const std::string& line);
+    // Reads one line. Returns false if the engine closed its output or nothing arrived before deadline.
+    bool readLine(std::string& line, Deadline deadline);
+    // Reads until a line starting with token. Returns false if readLine fails first.
+    bool waitFor(const std::string& token, Deadline deadline);
+    // Kills the process and closes the pipes, after a crash or hang
+    void kill();
+
+    EngineConfig config;
+    pid_t pid;
+    // Engine's standard input, written by us
+    FILE* in;
+    // Engine's standard output, read by us through buffer
+    int outFd;
+    std::string buffer;
+};
+
+static Deadline deadlineIn(int64_t ms) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+}
+
+// Both ends are close-on-exec, so engines started at the same time by other workers don't inherit them.
+// dup2 clears the flag on the copies which become the child's standard input and output.
+static bool makePipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC) == 0;
+#else
+    // No pipe2, so a fork on another thread can still slip in before the flags are set
+    if(pipe(fds) != 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+UciEngine::~UciEngine() {
+    if(in) {
+        send("quit");
+        fclose(in);
+    }
+    if(outFd >= 0) {
+        close(outFd);
+    }
+    if(pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+void UciEngine::kill() {
+    if(pid > 0) {
+        ::kill(-pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        pid = -1;
+    }
+    if(in) {
+        fclose(in);
+        in = nullptr;
+    }
+    if(outFd >= 0) {
+        close(outFd);
+        outFd = -1;
+    }
+    buffer.clear();
+}
+
+bool UciEngine::launch() {
+    int toEngine[2], fromEngine[2];
+    if(!makePipe(toEngine)) {
+        return false;
+    }
+    if(!makePipe(fromEngine)) {
+        close(toEngine[0]);
+        close(toEngine[1]);
+        return false;
+    }
+    pid = fork();
+    if(pid < 0) {
+        close(toEngine[0]);
+        close(toEngine[1]);
+        close(fromEngine[0]);
+        close(fromEngine[1]);
+        return false;
+    }
+    if(pid == 0) {
+        // Its own process group, so kill() also reaches anything the shell started
+        setpgid(0, 0);
+        dup2(toEngine[0], STDIN_FILENO);
+        dup2(fromEngine[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", config.cmd.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    // Also set here, so the group exists even if the child hasn't run yet
+    setpgid(pid, pid);
+    close(toEngine[0]);
+    close(fromEngine[1]);
+    in = fdopen(toEngine[1], "w");
+    outFd = fromEngine[0];
+
+    send("uci");
+    if(!waitFor("uciok", deadlineIn(HANDSHAKE_TIMEOUT))) {
+        kill();
+        return false;
+    }
+    for(const std::pair<std::string, std::string>& option : config.options) {
+        send("setoption name " + option.first + " value " + option.second);
+    }
+    send("isready");
+    if(!waitFor("readyok", deadlineIn(HANDSHAKE_TIMEOUT))) {
+        kill();
+        return false;
+    }
+    return true;
+}
+
+void UciEngine::send(const std::string& line) {
+    if(in) {
+        fputs((line + "\n").c_str(), in);
+        fflush(in);
+    }
+}
+
+bool UciEngine::readLine(std::string& line, Deadline deadline) {
+    size_t end;
+    while((end = buffer.find('\n')) == std::string::npos) {
+        if(outFd < 0) {
+            return false;
+        }
+        // Rounded up and one past the deadline, so a timed out move is always over its limit, never exactly on it
+        int64_t remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+        pollfd fd = {outFd, POLLIN, 0};
+        int ready = poll(&fd, 1, (int)std::max<int64_t>(0, (remaining + 999) / 1000) + 1);
+        if(ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if(ready <= 0) {
+            return false;
+        }
+        char chunk[4096];
+        ssize_t n = read(outFd, chunk, sizeof(chunk));
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, n);
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+bool UciEngine::waitFor(const std::string& token, Deadline deadline) {
+    std::string line;
+    while(readLine(line, deadline)) {
+        if(line.compare(0, token.size(), token) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UciEngine::newGame() {
+    // An engine killed during the last game gets a fresh process
+    if(pid < 0) {
+        return launch();
+    }
+    send("ucinewgame");
+    send("isready");
+    if(!waitFor("readyok", deadlineIn(HANDSHAKE_TIMEOUT))) {
+        kill();
+        return false;
+    }
+    return true;
+}
+
+std::string UciEngine::go(const std::string& fen, const std::vector<std::string>& moves, const SearchLimits& limits,
+                          int64_t timeLimit, int& score) {
+    std::string position = "position fen " + fen;
+    if(!moves.empty()) {
+        position += " moves";
+        for(const std::string& m : moves) {
+            position += " " + m;
+        }
+    }
+    send(position);
+    send("go wtime " + std::to_string(limits.wtime) + " btime " + std::to_string(limits.btime) +
+         " winc " + std::to_string(limits.winc) + " binc " + std::to_string(limits.binc));
+
+    score = 0;
+    Deadline deadline = deadlineIn(timeLimit);
+    std::string line, token;
+    while(readLine(line, deadline)) {
+        std::istringstream ss(line);
+        ss >> token;
+        if(token == "bestmove") {
+            std::string best;
+            ss >> best;
+            return best;
+        }
+        // Only the last score of the best line before bestmove matters
+        while(ss >> token) {
+            if(token == "multipv") {
+                int multipv = 1;
+                ss >> multipv;
+                if(multipv > 1) {
+                    break;
+                }
+            }
+            if(token != "score") {
+                continue;
+            }
+            int value = 0;
+            ss >> token >> value;
+            if(token == "cp") {
+                score = value;
+            } else if(token == "mate") {
+                score = (value > 0) ? MATE - (2 * value - 1) : -MATE - 2 * value;
+            }
+        }
+    }
+    // Crashed or out of time. Either way this process is finished with.
+    kill();
+    return "";
+}
+
+std::unique_ptr<Engine> createEngine(const EngineConfig& config) {
+    if(config.cmd.empty()) {
+        return std::unique_ptr<Engine>(new InProcessEngine(config));
+    }
+    // A crashed engine would otherwise take the whole match down on the next write
+    signal(SIGPIPE, SIG_IGN);
+    std::unique_ptr<UciEngine> engine(new UciEngine(config));
+    if(!engine->launch()) {
+        return nullptr;
+    }
+    return engine;
+}
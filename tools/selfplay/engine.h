@@ -0,0 +1,39 @@
+/*
+ *  Header information for the engines played by selfplay. An engine is either the core library searching
+ * in this process, or any UCI engine run as a child process and driven over pipes.
+ */
+
+#ifndef __selfplay_engine_h
+#define __selfplay_engine_h
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "search.h"
+
+// One --engine argument: a display name, the command line (empty to search in-process) and the
+// UCI options to set
+struct EngineConfig {
+    std::string name;
+    std::string cmd;
+    std::vector<std::pair<std::string, std::string>> options;
+};
+
+class Engine {
+    public:
+    virtual ~Engine() {}
+
+    // Clears anything kept from the previous game. Returns false if the engine stopped responding.
+    virtual bool newGame() = 0;
+    // Searches the position reached from fen by moves (coordinate notation) and returns the chosen move,
+    // or an empty string if the engine failed or took longer than timeLimit milliseconds. score is set to
+    // the engine's last reported score in centipawns from the side to move's point of view.
+    virtual std::string go(const std::string& fen, const std::vector<std::string>& moves,
+                           const SearchLimits& limits, int64_t timeLimit, int& score) = 0;
+};
+
+// Returns nullptr if the engine couldn't be started
+std::unique_ptr<Engine> createEngine(const EngineConfig& config);
+
+#endif
@@ -0,0 +1,555 @@
+/*
+ *  Self-play match runner. Plays many games at once between two engines from an opening suite, adjudicates
+ * them, writes them to a PGN file (and every position to a training data file) and stops as soon as a
+ * running SPRT reaches a decision.
+ *
+ *  selfplay --engine name=new --engine name=base cmd=./base/chess-uci option.Hash=16
+ *           --openings book.epd --games 20000 --concurrency 16 --tc 5+0.05
+ *           --sprt elo0=0 elo1=5 alpha=0.05 beta=0.05 --pgn games.pgn
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "engine.h"
+#include "sprt.h"
+#include "training.h"
+
+struct MatchOptions {
+    MatchOptions()
+        : games(100), concurrency(std::max(1u, std::thread::hardware_concurrency())), baseTime(10000),
+          increment(100), timeMargin(50), maxMoves(0), useSprt(false), elo0(0), elo1(5), alpha(0.05),
+          beta(0.05), resignMoveCount(3), resignScore(600), drawMoveNumber(40), drawMoveCount(8), drawScore(10) {}
+
+    EngineConfig engines[2];
+    std::string openingsFile;
+    std::string pgnFile;
+    std::string dataFile;
+    int games;
+    int concurrency;
+    // Clock in milliseconds. A move may overrun the clock by timeMargin before it counts as a loss on time.
+    int64_t baseTime;
+    int64_t increment;
+    int64_t timeMargin;
+    // Games still going after this many moves are drawn, 0 for no limit
+    int maxMoves;
+
+    bool useSprt;
+    double elo0, elo1, alpha, beta;
+
+    // A game is won once both engines agree on a score of at least resignScore for resignMoveCount moves
+    // each. It's drawn once both report at most drawScore for drawMoveCount moves each, from move
+    // drawMoveNumber on. A move count of 0 turns the rule off.
+    int resignMoveCount, resignScore;
+    int drawMoveNumber, drawMoveCount, drawScore;
+};
+
+struct GameRecord {
+    std::string fen;
+    std::string white;
+    std::string black;
+    int round;
+    std::vector<std::string> san;
+    std::string result;
+    // PGN Termination tag and a human readable reason
+    std::string termination;
+    std::string reason;
+    // Every position played, for training data. Results are filled in once the game is over.
+    std::vector<TrainingRecord> positions;
+};
+
+// MOVE NOTATION
+
+// Standard algebraic notation for a legal move, needed for PGN. legal holds every legal move in the position.
+static std::string toSan(Board& board, const Move& m, const std::list<Move>& legal) {
+    const Square& from = std::get<0>(m);
+    const Square& to = std::get<1>(m);
+    char type = std::get<2>(m);
+    std::string san;
+
+    if(type == 'C') {
+        san = (to.second == 6) ? "O-O" : "O-O-O";
+    } else {
+        char piece = board.getPiece(from.first, from.second).pieceType;
+        bool capture = type == 'E' || !board.getPiece(to.first, to.second).isNull();
+        if(piece == 'p') {
+            if(capture) {
+                san += (char)('a' + from.second);
+            }
+        } else {
+            san += (char)std::toupper(piece);
+            // Name the file, the rank or both, whichever tells this move apart from others to the same square
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for(const Move& other : legal) {
+                const Square& otherFrom = std::get<0>(other);
+                if(std::get<1>(other) != to || otherFrom == from || board.getPiece(otherFrom.first, otherFrom.second).pieceType != piece) {
+                    continue;
+                }
+                ambiguous = true;
+                sameFile |= otherFrom.second == from.second;
+                sameRank |= otherFrom.first == from.first;
+            }
+            if(ambiguous) {
+                if(!sameFile) {
+                    san += (char)('a' + from.second);
+                } else if(!sameRank) {
+                    san += (char)('8' - from.first);
+                } else {
+                    san += squareToString(from);
+                }
+            }
+        }
+        if(capture) {
+            san += 'x';
+        }
+        san += squareToString(to);
+        if(isPromotion(m)) {
+            san += '=';
+            san += (char)std::toupper(type);
+        }
+    }
+
+    board.forwardMove(m);
+    if(board.isCheck(board.isWhiteToMove())) {
+        std::list<Move> replies;
+        board.generateLegalMoves(replies);
+        san += replies.empty() ? '#' : '+';
+    }
+    board.reverseMove(m);
+    return san;
+}
+
+// GAME PLAY
+
+// Neither side can mate: bare kings, or a single minor piece left
+static bool isInsufficientMaterial(const Board& board) {
+    int minors = 0;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            char type = board.getPiece(r, c).pieceType;
+            if(type == 'p' || type == 'r' || type == 'q') {
+                return false;
+            }
+            if(type == 'n' || type == 'b') {
+                minors++;
+            }
+        }
+    }
+    return minors <= 1;
+}
+
+static void finish(GameRecord& record, const std::string& result, const std::string& termination, const std::string& reason) {
+    record.result = result;
+    record.termination = termination;
+    record.reason = reason;
+}
+
+// Plays one game from record.fen and fills in the moves and the result
+static void playGame(Engine* white, Engine* black, const MatchOptions& options, GameRecord& record) {
+    Board board(record.fen);
+    Engine* engines[2] = {white, black};
+    std::vector<std::string> moves;
+    std::vector<uint64_t> keys(1, board.getKey());
+    int64_t clock[2] = {options.baseTime, options.baseTime};
+    // Consecutive plies with a winning score for white and for black, and with a drawn score
+    int winStreak[2] = {0, 0};
+    int drawStreak = 0;
+
+    if(!white->newGame() || !black->newGame()) {
+        finish(record, "*", "abandoned", "engine stopped responding");
+        return;
+    }
+
+    while(true) {
+        bool isWhite = board.isWhiteToMove();
+        int side = isWhite ? 0 : 1;
+        std::string loser = isWhite ? "0-1" : "1-0";
+        std::string name = isWhite ? record.white : record.black;
+
+        std::list<Move> legal;
+        board.generateLegalMoves(legal);
+        if(legal.empty()) {
+            if(board.isCheck(isWhite)) {
+                finish(record, loser, "normal", (isWhite ? "Black" : "White") + std::string(" mates"));
+            } else {
+                finish(record, "1/2-1/2", "normal", "Stalemate");
+            }
+            return;
+        }
+        if(board.getHalfmoveClock() >= 100) {
+            finish(record, "1/2-1/2", "normal", "Fifty move rule");
+            return;
+        }
+        if(std::count(keys.begin(), keys.end(), board.getKey()) >= 3) {
+            finish(record, "1/2-1/2", "normal", "Threefold repetition");
+            return;
+        }
+        if(isInsufficientMaterial(board)) {
+            finish(record, "1/2-1/2", "normal", "Insufficient material");
+            return;
+        }
+        if(options.maxMoves > 0 && (int)moves.size() >= 2 * options.maxMoves) {
+            finish(record, "1/2-1/2", "adjudication", "Move limit");
+            return;
+        }
+
+        SearchLimits limits;
+        limits.wtime = clock[0];
+        limits.btime = clock[1];
+        limits.hasWtime = limits.hasBtime = true;
+        limits.winc = limits.binc = options.increment;
+        int score = 0;
+        auto begin = std::chrono::steady_clock::now();
+        // Past this the move is lost on time, so there's no point waiting any longer for a hung engine
+        std::string reply = engines[side]->go(record.fen, moves, limits, clock[side] + options.timeMargin, score);
+        clock[side] -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+
+        // Checked first, since an engine which never answered also returns no move
+        if(clock[side] < -options.timeMargin) {
+            finish(record, loser, "time forfeit", name + " loses on time");
+            return;
+        }
+        if(reply.empty()) {
+            finish(record, loser, "abandoned", name + " stopped responding");
+            return;
+        }
+        clock[side] += options.increment;
+        Move m = parseMove(board, reply);
+        if(isNullMove(m)) {
+            finish(record, loser, "rules infraction", name + " plays illegal move " + reply);
+            return;
+        }
+
+        record.positions.push_back(makeRecord(board, score, m, 0));
+        record.san.push_back(toSan(board, m, legal));
+        board.forwardMove(m);
+        moves.push_back(reply);
+        keys.push_back(board.getKey());
+
+        // Both engines have to agree, so a streak only grows while the scores from both sides line up
+        int whiteScore = isWhite ? score : -score;
+        winStreak[0] = (whiteScore >= options.resignScore) ? winStreak[0] + 1 : 0;
+        winStreak[1] = (whiteScore <= -options.resignScore) ? winStreak[1] + 1 : 0;
+        for(int c = 0; c < 2; c++) {
+            if(options.resignMoveCount > 0 && winStreak[c] >= 2 * options.resignMoveCount) {
+                finish(record, (c == 0) ? "1-0" : "0-1", "adjudication", "Score adjudication");
+                return;
+            }
+        }
+        int moveNumber = board.getPly() / 2 + 1;
+        drawStreak = (moveNumber >= options.drawMoveNumber && std::abs(score) <= options.drawScore) ? drawStreak + 1 : 0;
+        if(options.drawMoveCount > 0 && drawStreak >= 2 * options.drawMoveCount) {
+            finish(record, "1/2-1/2", "adjudication", "Draw adjudication");
+            return;
+        }
+    }
+}
+
+// OUTPUT
+
+static void writePgn(std::ostream& os, const GameRecord& record, const MatchOptions& options) {
+    char date[16];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+
+    os << "[Event \"selfplay\"]\n";
+    os << "[Site \"?\"]\n";
+    os << "[Date \"" << date << "\"]\n";
+    os << "[Round \"" << record.round << "\"]\n";
+    os << "[White \"" << record.white << "\"]\n";
+    os << "[Black \"" << record.black << "\"]\n";
+    os << "[Result \"" << record.result << "\"]\n";
+    os << "[FEN \"" << record.fen << "\"]\n";
+    os << "[SetUp \"1\"]\n";
+    os << "[TimeControl \"" << options.baseTime / 1000.0 << "+" << options.increment / 1000.0 << "\"]\n";
+    os << "[Termination \"" << record.termination << "\"]\n";
+    os << "[PlyCount \"" << record.san.size() << "\"]\n\n";
+
+    // Move text, wrapped at 80 columns
+    Board board(record.fen);
+    int ply = board.getPly();
+    std::string line;
+    for(size_t i = 0; i < record.san.size(); i++, ply++) {
+        std::string token;
+        if(ply % 2 == 0) {
+            token = std::to_string(ply / 2 + 1) + ". ";
+        } else if(i == 0) {
+            token = std::to_string(ply / 2 + 1) + "... ";
+        }
+        token += record.san[i];
+        if(!line.empty() && line.size() + token.size() + 1 > 80) {
+            os << line << "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    }
+    std::string ending = "{" + record.reason + "} " + record.result;
+    if(!line.empty() && line.size() + ending.size() + 1 > 80) {
+        os << line << "\n";
+        line.clear();
+    }
+    os << line << (line.empty() ? "" : " ") << ending << "\n\n";
+    os.flush();
+}
+
+// Openings are EPD or FEN lines. Only the position fields are used, EPD operations are ignored.
+static bool loadOpenings(const std::string& file, std::vector<std::string>& openings) {
+    std::ifstream in(file);
+    if(!in) {
+        return false;
+    }
+    std::string line;
+    while(std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string fields[6];
+        int count = 0;
+        while(count < 6 && ss >> fields[count]) {
+            count++;
+        }
+        if(count < 4) {
+            continue;
+        }
+        bool hasCounters = count == 6 && std::isdigit(fields[4][0]) && std::isdigit(fields[5][0]);
+        std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " " +
+                          (hasCounters ? fields[4] + " " + fields[5] : "0 1");
+        openings.push_back(fen);
+    }
+    return !openings.empty();
+}
+
+// MATCH
+
+// Shared between the worker threads, guarded by lock
+struct Match {
+    Match(const MatchOptions& o) : options(o), sprt(o.elo0, o.elo1, o.alpha, o.beta), nextGame(0), stopped(false),
+                                   wins(0), draws(0), losses(0) {}
+
+    const MatchOptions& options;
+    std::vector<std::string> openings;
+    Sprt sprt;
+    std::ofstream pgn;
+    TrainingWriter data;
+    std::mutex lock;
+    int nextGame;
+    std::atomic<bool> stopped;
+    // From the first engine's point of view
+    int wins, draws, losses;
+};
+
+static void printScore(Match& match) {
+    const MatchOptions& options = match.options;
+    int games = match.wins + match.draws + match.losses;
+    double elo, margin;
+    eloEstimate(match.wins, match.draws, match.losses, elo, margin);
+    std::cout << "Score of " << options.engines[0].name << " vs " << options.engines[1].name << ": " << match.wins
+              << " - " << match.losses << " - " << match.draws << " [" << std::fixed << std::setprecision(3)
+              << (match.wins + match.draws / 2.0) / games << "] " << games << std::endl;
+    std::cout << "Elo difference: " << std::setprecision(1) << elo << " +/- " << margin;
+    if(options.useSprt) {
+        std::cout << ", LLR: " << std::setprecision(2) << match.sprt.llr(match.wins, match.draws, match.losses) << " ("
+                  << match.sprt.lowerBound() << ", " << match.sprt.upperBound() << ") [" << std::setprecision(1)
+                  << options.elo0 << ", " << options.elo1 << "]";
+    }
+    std::cout << std::endl;
+}
+
+// Each worker plays one game at a time with its own pair of engines, which are reused between games
+static void worker(Match& match) {
+    const MatchOptions& options = match.options;
+    std::unique_ptr<Engine> engines[2];
+    for(int i = 0; i < 2; i++) {
+        engines[i] = createEngine(options.engines[i]);
+        if(!engines[i]) {
+            std::lock_guard<std::mutex> guard(match.lock);
+            std::cerr << "Could not start " << options.engines[i].name << ": " << options.engines[i].cmd << std::endl;
+            match.stopped = true;
+            return;
+        }
+    }
+
+    while(true) {
+        int game;
+        {
+            std::lock_guard<std::mutex> guard(match.lock);
+            if(match.stopped || match.nextGame >= options.games) {
+                return;
+            }
+            game = match.nextGame++;
+        }
+
+        // Each opening is played twice with colors reversed so neither engine gets the better side of it
+        int first = game % 2;
+        GameRecord record;
+        record.fen = match.openings[(game / 2) % match.openings.size()];
+        record.round = game + 1;
+        record.white = options.engines[first].name;
+        record.black = options.engines[1 - first].name;
+        playGame(engines[first].get(), engines[1 - first].get(), options, record);
+
+        std::lock_guard<std::mutex> guard(match.lock);
+        if(match.pgn.is_open()) {
+            writePgn(match.pgn, record, options);
+        }
+        if(record.result == "*") {
+            std::cerr << "Game " << record.round << " abandoned: " << record.reason << std::endl;
+            continue;
+        }
+        int8_t result = (record.result == "1-0") ? 1 : (record.result == "0-1") ? -1 : 0;
+        for(TrainingRecord& position : record.positions) {
+            position.result = result;
+            match.data.write(position);
+        }
+        std::cout << "Finished game " << record.round << " (" << record.white << " vs " << record.black << "): "
+                  << record.result << " {" << record.reason << "}" << std::endl;
+        if(record.result == "1/2-1/2") {
+            match.draws++;
+        } else if((record.result == "1-0") == (first == 0)) {
+            match.wins++;
+        } else {
+            match.losses++;
+        }
+        printScore(match);
+
+        if(options.useSprt && !match.stopped) {
+            int status = match.sprt.status(match.wins, match.draws, match.losses);
+            if(status != 0) {
+                std::cout << "SPRT: " << (status > 0 ? "H1" : "H0") << " accepted" << std::endl;
+                match.stopped = true;
+            }
+        }
+    }
+}
+
+// COMMAND LINE
+
+static void usage() {
+    std::cerr << "Usage: selfplay --engine name=<name> [cmd=<command>] [option.<name>=<value> ...] (twice)\n"
+                 "                [--openings <file.epd>] [--games <n>] [--concurrency <n>] [--tc <seconds>+<inc>]\n"
+                 "                [--timemargin <ms>] [--maxmoves <n>] [--pgn <file>] [--data <file>]\n"
+                 "                [--sprt elo0=<e> elo1=<e> alpha=<a> beta=<b>]\n"
+                 "                [--resign movecount=<n> score=<cp>] [--draw movenumber=<n> movecount=<n> score=<cp>]\n"
+                 "An engine without cmd searches in this process with the core library.\n";
+}
+
+// Splits key=value
+static void splitPair(const std::string& arg, std::string& key, std::string& value) {
+    size_t eq = arg.find('=');
+    key = arg.substr(0, eq);
+    value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+}
+
+static bool parseArgs(int argc, char* argv[], MatchOptions& options) {
+    int engineCount = 0;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        // Arguments up to the next flag
+        std::vector<std::string> values;
+        while(i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0) {
+            values.push_back(argv[++i]);
+        }
+        std::string key, value;
+        if(arg == "--engine") {
+            if(engineCount == 2) {
+                return false;
+            }
+            EngineConfig& config = options.engines[engineCount++];
+            config.name = "engine" + std::to_string(engineCount);
+            for(const std::string& v : values) {
+                splitPair(v, key, value);
+                if(key == "name") config.name = value;
+                else if(key == "cmd") config.cmd = value;
+                else if(key.compare(0, 7, "option.") == 0) config.options.push_back(std::make_pair(key.substr(7), value));
+                else return false;
+            }
+        } else if(arg == "--sprt" || arg == "--resign" || arg == "--draw") {
+            options.useSprt |= arg == "--sprt";
+            for(const std::string& v : values) {
+                splitPair(v, key, value);
+                if(arg == "--sprt" && key == "elo0") options.elo0 = std::stod(value);
+                else if(arg == "--sprt" && key == "elo1") options.elo1 = std::stod(value);
+                else if(arg == "--sprt" && key == "alpha") options.alpha = std::stod(value);
+                else if(arg == "--sprt" && key == "beta") options.beta = std::stod(value);
+                else if(arg == "--resign" && key == "movecount") options.resignMoveCount = std::stoi(value);
+                else if(arg == "--resign" && key == "score") options.resignScore = std::stoi(value);
+                else if(arg == "--draw" && key == "movenumber") options.drawMoveNumber = std::stoi(value);
+                else if(arg == "--draw" && key == "movecount") options.drawMoveCount = std::stoi(value);
+                else if(arg == "--draw" && key == "score") options.drawScore = std::stoi(value);
+                else return false;
+            }
+        } else if(values.size() != 1) {
+            return false;
+        } else if(arg == "--openings") {
+            options.openingsFile = values[0];
+        } else if(arg == "--pgn") {
+            options.pgnFile = values[0];
+        } else if(arg == "--data") {
+            options.dataFile = values[0];
+        } else if(arg == "--games") {
+            options.games = std::stoi(values[0]);
+        } else if(arg == "--concurrency") {
+            options.concurrency = std::max(1, std::stoi(values[0]));
+        } else if(arg == "--tc") {
+            size_t plus = values[0].find('+');
+            options.baseTime = (int64_t)(std::stod(values[0].substr(0, plus)) * 1000);
+            options.increment = (plus == std::string::npos) ? 0 : (int64_t)(std::stod(values[0].substr(plus + 1)) * 1000);
+        } else if(arg == "--timemargin") {
+            options.timeMargin = std::stoi(values[0]);
+        } else if(arg == "--maxmoves") {
+            options.maxMoves = std::stoi(values[0]);
+        } else {
+            return false;
+        }
+    }
+    return engineCount == 2;
+}
+
+int main(int argc, char* argv[]) {
+    MatchOptions options;
+    try {
+        if(!parseArgs(argc, argv, options)) {
+            usage();
+            return 1;
+        }
+    } catch(const std::exception&) {
+        usage();
+        return 1;
+    }
+
+    Match match(options);
+    if(options.openingsFile.empty()) {
+        match.openings.push_back(START_FEN);
+    } else if(!loadOpenings(options.openingsFile, match.openings)) {
+        std::cerr << "No openings found in " << options.openingsFile << std::endl;
+        return 1;
+    }
+    if(!options.pgnFile.empty()) {
+        match.pgn.open(options.pgnFile, std::ios::app);
+    }
+    if(!options.dataFile.empty() && !match.data.open(options.dataFile, true)) {
+        std::cerr << "Could not open " << options.dataFile << std::endl;
+        return 1;
+    }
+
+    std::vector<std::thread> workers;
+    for(int i = 0; i < std::min(options.concurrency, options.games); i++) {
+        workers.push_back(std::thread(worker, std::ref(match)));
+    }
+    for(std::thread& t : workers) {
+        t.join();
+    }
+    if(match.wins + match.draws + match.losses > 0) {
+        std::cout << "Finished match" << std::endl;
+        printScore(match);
+    }
+    return 0;
+}
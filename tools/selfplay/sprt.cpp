@@ -0,0 +1,59 @@
+/*
+ *  CPP Implementation for the match statistics
+ */
+
+#include "sprt.h"
+#include <algorithm>
+#include <cmath>
+
+// Expected score for a logistic Elo difference
+static double eloToScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+static double scoreToElo(double score) {
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+Sprt::Sprt(double e0, double e1, double alpha, double beta) : elo0(e0), elo1(e1) {
+    lower = std::log(beta / (1.0 - alpha));
+    upper = std::log((1.0 - beta) / alpha);
+}
+
+double Sprt::llr(int wins, int draws, int losses) const {
+    // Until both a win and a loss are in, the variance estimate is meaningless
+    if(wins == 0 || losses == 0) {
+        return 0.0;
+    }
+    double n = wins + draws + losses;
+    double w = wins / n, d = draws / n, l = losses / n;
+    double s = w + d / 2;
+    double variance = w * (1 - s) * (1 - s) + d * (0.5 - s) * (0.5 - s) + l * s * s;
+    double s0 = eloToScore(elo0), s1 = eloToScore(elo1);
+    return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * variance);
+}
+
+int Sprt::status(int wins, int draws, int losses) const {
+    double value = llr(wins, draws, losses);
+    if(value >= upper) {
+        return 1;
+    }
+    if(value <= lower) {
+        return -1;
+    }
+    return 0;
+}
+
+void eloEstimate(int wins, int draws, int losses, double& elo, double& margin) {
+    double n = wins + draws + losses;
+    if(n == 0) {
+        elo = margin = 0;
+        return;
+    }
+    double w = wins / n, d = draws / n, l = losses / n;
+    double s = w + d / 2;
+    double deviation = std::sqrt((w * (1 - s) * (1 - s) + d * (0.5 - s) * (0.5 - s) + l * s * s) / n);
+    elo = scoreToElo(s);
+    margin = (scoreToElo(s + 1.96 * deviation) - scoreToElo(s - 1.96 * deviation)) / 2;
+}
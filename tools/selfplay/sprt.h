@@ -0,0 +1,35 @@
+/*
+ *  Header information for the match statistics: the sequential probability ratio test which decides when
+ * enough games have been played, and the Elo estimate printed alongside it.
+ */
+
+#ifndef __selfplay_sprt_h
+#define __selfplay_sprt_h
+
+// Tests H0: elo = elo0 against H1: elo = elo1 with false positive rate alpha and false negative rate beta.
+// Elo is logistic and results are from the first engine's point of view.
+class Sprt {
+    public:
+    Sprt(double elo0, double elo1, double alpha, double beta);
+
+    // Log likelihood ratio of the results so far, using the trinomial (win/draw/loss) approximation
+    double llr(int wins, int draws, int losses) const;
+    // 1 if H1 is accepted, -1 if H0 is accepted, 0 to keep playing
+    int status(int wins, int draws, int losses) const;
+
+    double getElo0() const { return elo0; }
+    double getElo1() const { return elo1; }
+    double lowerBound() const { return lower; }
+    double upperBound() const { return upper; }
+
+    private:
+    double elo0;
+    double elo1;
+    double lower;
+    double upper;
+};
+
+// Elo difference implied by the score so far and its 95% confidence margin
+void eloEstimate(int wins, int draws, int losses, double& elo, double& margin);
+
+#endif
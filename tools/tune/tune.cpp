@@ -0,0 +1,428 @@
+/*
+ *  Texel tuner for the evaluation weights. Loads positions labeled with their game result, reduces each
+ * to the sparse list of weights its evaluation uses, then fits the weights with Adam so that a sigmoid
+ * of the evaluation predicts the results. The result is written as a new eval_weights.h.
+ *
+ *  tune --data games.bin [--data quiet-labeled.epd ...] [--epochs 2000] [--lr 1.0] [--threads <n>]
+ *       [--all] [--output eval_weights.h]
+ *
+ *  The header is written to eval_weights.h in the current directory unless --output says otherwise.
+ *
+ *  Binary files are training data written by selfplay --data. Text files hold one position per line,
+ * FEN or EPD followed by its result as "1-0", "0-1", "1/2-1/2" or [1.0], [0.5], [0.0].
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "board.h"
+#include "eval_weights.h"
+#include "evaluate.h"
+#include "training.h"
+
+// Weight layout: material for each piece, then a piece-square table for each piece. Both kings are always on
+// the board, so the king's material cancels out and is never a feature.
+const int KING = 5;
+const int PST_OFFSET = 6;
+const int NUM_WEIGHTS = PST_OFFSET + 6 * 64;
+
+static const char* pieceNames[6] = {"Pawn", "Knight", "Bishop", "Rook", "Queen", "King"};
+
+// Positions stored as sparse features. Position i uses the weights indices[offsets[i]..offsets[i+1]),
+// each counted coefficients[j] times (positive for white, negative for black).
+struct Dataset {
+    Dataset() : offsets(1, 0) {}
+
+    size_t size() const { return results.size(); }
+    void append(const Dataset& other);
+
+    std::vector<uint64_t> offsets;
+    std::vector<uint16_t> indices;
+    std::vector<int8_t> coefficients;
+    // From white's point of view: 1 win, 0.5 draw, 0 loss
+    std::vector<float> results;
+};
+
+void Dataset::append(const Dataset& other) {
+    uint64_t base = offsets.back();
+    for(size_t i = 1; i < other.offsets.size(); i++) {
+        offsets.push_back(base + other.offsets[i]);
+    }
+    indices.insert(indices.end(), other.indices.begin(), other.indices.end());
+    coefficients.insert(coefficients.end(), other.coefficients.begin(), other.coefficients.end());
+    results.insert(results.end(), other.results.begin(), other.results.end());
+}
+
+// FEATURES
+
+// Set if a position's features disagree with evaluate(), which means addPosition is out of date
+static std::atomic<bool> featureMismatch(false);
+
+// Reduces board to the weights evaluate() reads, merging repeats. Must mirror evaluate() exactly.
+static void addPosition(Dataset& data, const Board& board, float result) {
+    int counts[NUM_WEIGHTS] = {0};
+    bool seen[NUM_WEIGHTS] = {false};
+    std::vector<uint16_t> used;
+    for(unsigned int r = 0; r < 8; r++) {
+        for(unsigned int c = 0; c < 8; c++) {
+            const Piece& p = board.getPiece(r,c);
+            if(p.isNull()) {
+                continue;
+            }
+            int piece = pieceIndex(p.pieceType);
+            int sign = (p.isWhite) ? 1 : -1;
+            int features[2] = {PST_OFFSET + piece * 64 + (int)((p.isWhite) ? r : 7 - r) * 8 + (int)c, piece};
+            for(int i = 0; i < ((piece == KING) ? 1 : 2); i++) {
+                int f = features[i];
+                if(!seen[f]) {
+                    seen[f] = true;
+                    used.push_back(f);
+                }
+                counts[f] += sign;
+            }
+        }
+    }
+    int eval = 0;
+    for(uint16_t f : used) {
+        if(counts[f] != 0) {
+            data.indices.push_back(f);
+            data.coefficients.push_back((int8_t)counts[f]);
+            eval += counts[f] * ((f < PST_OFFSET) ? materialWeights[f] : pieceSquareWeights[(f - PST_OFFSET) / 64][(f - PST_OFFSET) % 64 / 8][(f - PST_OFFSET) % 8]);
+        }
+    }
+    if(eval != ((board.isWhiteToMove()) ? evaluate(board) : -evaluate(board))) {
+        featureMismatch = true;
+    }
+    data.offsets.push_back(data.indices.size());
+    data.results.push_back(result);
+}
+
+// Texel tuning wants quiet positions, where the static evaluation means something
+static bool isQuiet(Board& board, const Move& best) {
+    if(board.isCheck(board.isWhiteToMove())) {
+        return false;
+    }
+    return isNullMove(best) || (!board.isCapture(best) && !isPromotion(best));
+}
+
+// LOADING
+
+// Training data, converted on all threads at once
+static bool loadBinary(const std::string& path, Dataset& data, int threads, bool all) {
+    TrainingReader reader;
+    if(!reader.open(path)) {
+        return false;
+    }
+    std::vector<Dataset> parts(threads);
+    reader.parallelForEach(threads, [&](int index, const TrainingRecord* first, const TrainingRecord* last) {
+        Board board;
+        for(const TrainingRecord* r = first; r != last; r++) {
+            if(!board.unpack(r->position) || (!all && !isQuiet(board, unpackMove(r->move)))) {
+                continue;
+            }
+            addPosition(parts[index], board, (r->result + 1) / 2.0f);
+        }
+    });
+    for(const Dataset& part : parts) {
+        data.append(part);
+    }
+    return true;
+}
+
+static bool loadText(const std::string& path, Dataset& data, bool all) {
+    std::ifstream in(path);
+    if(!in) {
+        return false;
+    }
+    std::string line;
+    while(std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string fields[4];
+        if(!(ss >> fields[0] >> fields[1] >> fields[2] >> fields[3])) {
+            continue;
+        }
+        // The result comes after the position. Look for it past the four position fields.
+        std::string rest;
+        std::getline(ss, rest);
+        float result;
+        if(rest.find("1/2-1/2") != std::string::npos || rest.find("[0.5]") != std::string::npos) {
+            result = 0.5f;
+        } else if(rest.find("1-0") != std::string::npos || rest.find("[1.0]") != std::string::npos) {
+            result = 1.0f;
+        } else if(rest.find("0-1") != std::string::npos || rest.find("[0.0]") != std::string::npos) {
+            result = 0.0f;
+        } else {
+            continue;
+        }
+        Board board;
+        if(!board.setFen(fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3]) || (!all && !isQuiet(board, Move()))) {
+            continue;
+        }
+        addPosition(data, board, result);
+    }
+    return true;
+}
+
+// Binary files are recognized by their header, everything else is read as text
+static bool load(const std::string& path, Dataset& data, int threads, bool all) {
+    TrainingReader probe;
+    if(probe.open(path)) {
+        probe.close();
+        return loadBinary(path, data, threads, all);
+    }
+    return loadText(path, data, all);
+}
+
+// OPTIMIZATION
+
+static double sigmoid(double eval, double k) {
+    return 1.0 / (1.0 + std::exp(-k * eval * std::log(10.0) / 400.0));
+}
+
+static double evalFeatures(const Dataset& data, size_t i, const std::vector<double>& weights) {
+    double eval = 0;
+    for(uint64_t j = data.offsets[i]; j < data.offsets[i + 1]; j++) {
+        eval += weights[data.indices[j]] * data.coefficients[j];
+    }
+    return eval;
+}
+
+// Mean squared error of the predicted results. If gradient is given, it's filled with the gradient of
+// the error with respect to each weight. Positions are split evenly across threads.
+static double computeLoss(const Dataset& data, const std::vector<double>& weights, double k, int threads,
+                          std::vector<double>* gradient) {
+    std::vector<double> losses(threads, 0.0);
+    std::vector<std::vector<double>> gradients(threads);
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&, t]() {
+            size_t first = data.size() * t / threads, last = data.size() * (t + 1) / threads;
+            if(gradient) {
+                gradients[t].assign(NUM_WEIGHTS, 0.0);
+            }
+            double loss = 0;
+            for(size_t i = first; i < last; i++) {
+                double p = sigmoid(evalFeatures(data, i, weights), k);
+                double error = p - data.results[i];
+                loss += error * error;
+                if(!gradient) {
+                    continue;
+                }
+                double g = error * p * (1 - p);
+                for(uint64_t j = data.offsets[i]; j < data.offsets[i + 1]; j++) {
+                    gradients[t][data.indices[j]] += g * data.coefficients[j];
+                }
+            }
+            losses[t] = loss;
+        }));
+    }
+    for(std::thread& w : workers) {
+        w.join();
+    }
+
+    double loss = 0;
+    for(int t = 0; t < threads; t++) {
+        loss += losses[t];
+    }
+    if(gradient) {
+        // d/dw of (p - r)^2 is 2 (p - r) p (1 - p) k ln(10) / 400 times the feature's coefficient
+        double scale = 2.0 * k * std::log(10.0) / 400.0 / data.size();
+        gradient->assign(NUM_WEIGHTS, 0.0);
+        for(int t = 0; t < threads; t++) {
+            for(int w = 0; w < NUM_WEIGHTS; w++) {
+                (*gradient)[w] += gradients[t][w] * scale;
+            }
+        }
+    }
+    return loss / data.size();
+}
+
+// The sigmoid's scale, chosen so the starting weights fit the results as well as they can. It stays
+// fixed while tuning so the weights keep their centipawn scale.
+static double fitK(const Dataset& data, const std::vector<double>& weights, int threads) {
+    double best = 1.0, step = 0.5;
+    double bestLoss = computeLoss(data, weights, best, threads, nullptr);
+    for(int round = 0; round < 6; round++, step /= 4) {
+        for(double k = std::max(0.05, best - 4 * step); k <= best + 4 * step; k += step) {
+            double loss = computeLoss(data, weights, k, threads, nullptr);
+            if(loss < bestLoss) {
+                bestLoss = loss;
+                best = k;
+            }
+        }
+    }
+    return best;
+}
+
+// A piece's material and its table entries are always counted together, so the data only fixes their sum
+// and the optimizer could trade one for the other freely. Keeping every table's mean at zero pins material
+// to the piece's average value. Neither changes the evaluation of any position. The king's material never
+// counts, so its table's mean is simply dropped.
+static void centreTables(std::vector<double>& weights) {
+    for(int p = 0; p < 6; p++) {
+        // Pawns never stand on the first or last row, so those entries are left alone
+        int first = (p == 0) ? 1 : 0, last = (p == 0) ? 6 : 7;
+        double mean = 0;
+        for(int r = first; r <= last; r++) {
+            for(int c = 0; c < 8; c++) {
+                mean += weights[PST_OFFSET + p * 64 + r * 8 + c];
+            }
+        }
+        mean /= (last - first + 1) * 8;
+        for(int r = first; r <= last; r++) {
+            for(int c = 0; c < 8; c++) {
+                weights[PST_OFFSET + p * 64 + r * 8 + c] -= mean;
+            }
+        }
+        if(p != KING) {
+            weights[p] += mean;
+        }
+    }
+}
+
+// OUTPUT
+
+static bool writeHeader(const std::string& path, const std::vector<double>& weights, size_t positions, double loss) {
+    std::ofstream out(path);
+    if(!out) {
+        return false;
+    }
+    out << "/*\n"
+           " *  Evaluation weights in centipawns, written by the tune tool (tools/tune). Regenerate them from data\n"
+           " * rather than editing by hand. Piece-square tables are from white's point of view with row 0 being the\n"
+           " * eighth rank; black pieces read them mirrored vertically.\n"
+           " *\n"
+           " *  Tuned on " << positions << " positions, final loss " << std::setprecision(6) << loss << "\n"
+           " */\n\n"
+           "#ifndef __eval_weights_h\n"
+           "#define __eval_weights_h\n\n"
+           "// Indexed by piece: pawn, knight, bishop, rook, queen, king\n"
+           "const int materialWeights[6] = {";
+    for(int p = 0; p < 6; p++) {
+        out << (p ? ", " : "") << (int)std::lround(weights[p]);
+    }
+    out << "};\n\nconst int pieceSquareWeights[6][8][8] = {\n";
+    for(int p = 0; p < 6; p++) {
+        out << "    // " << pieceNames[p] << "\n    {\n";
+        for(int r = 0; r < 8; r++) {
+            out << "        {";
+            for(int c = 0; c < 8; c++) {
+                out << (c ? "," : "") << std::setw(4) << (int)std::lround(weights[PST_OFFSET + p * 64 + r * 8 + c]);
+            }
+            out << "}" << (r < 7 ? "," : "") << "\n";
+        }
+        out << "    }" << (p < 5 ? "," : "") << "\n";
+    }
+    out << "};\n\n#endif\n";
+    return true;
+}
+
+// COMMAND LINE
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> files;
+    std::string output = "eval_weights.h";
+    int epochs = 2000;
+    double rate = 1.0;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool all = false;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--all") {
+            all = true;
+        } else if(i + 1 >= argc) {
+            files.clear();
+            break;
+        } else if(arg == "--data") {
+            files.push_back(argv[++i]);
+        } else if(arg == "--output") {
+            output = argv[++i];
+        } else if(arg == "--epochs") {
+            epochs = std::stoi(argv[++i]);
+        } else if(arg == "--lr") {
+            rate = std::stod(argv[++i]);
+        } else if(arg == "--threads") {
+            threads = std::max(1, std::stoi(argv[++i]));
+        } else {
+            files.clear();
+            break;
+        }
+    }
+    if(files.empty()) {
+        std::cerr << "Usage: tune --data <file> [--data <file> ...] [--epochs <n>] [--lr <rate>] [--threads <n>]\n"
+                     "            [--all] [--output <eval_weights.h>]\n"
+                     "Positions in check or with a capture as best move are skipped unless --all is given.\n";
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    Dataset data;
+    for(const std::string& file : files) {
+        if(!load(file, data, threads, all)) {
+            std::cerr << "Could not read " << file << std::endl;
+            return 1;
+        }
+    }
+    if(data.size() == 0) {
+        std::cerr << "No positions loaded" << std::endl;
+        return 1;
+    }
+    if(featureMismatch) {
+        std::cerr << "Features don't match evaluate(), update addPosition to follow it" << std::endl;
+        return 1;
+    }
+    int64_t loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Loaded " << data.size() << " positions (" << data.indices.size() << " features) in " << loadTime << " ms" << std::endl;
+
+    std::vector<double> weights(NUM_WEIGHTS);
+    for(int p = 0; p < 6; p++) {
+        weights[p] = materialWeights[p];
+        for(int sq = 0; sq < 64; sq++) {
+            weights[PST_OFFSET + p * 64 + sq] = pieceSquareWeights[p][sq / 8][sq % 8];
+        }
+    }
+    centreTables(weights);
+
+    double k = fitK(data, weights, threads);
+    std::cout << "K = " << k << ", starting loss " << std::setprecision(6) << computeLoss(data, weights, k, threads, nullptr) << std::endl;
+
+    // Adam, full batch. Every step uses the gradient over the whole data set.
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> gradient, m(NUM_WEIGHTS, 0.0), v(NUM_WEIGHTS, 0.0);
+    double loss = 0;
+    for(int epoch = 1; epoch <= epochs; epoch++) {
+        loss = computeLoss(data, weights, k, threads, &gradient);
+        for(int w = 0; w < NUM_WEIGHTS; w++) {
+            m[w] = beta1 * m[w] + (1 - beta1) * gradient[w];
+            v[w] = beta2 * v[w] + (1 - beta2) * gradient[w] * gradient[w];
+            double mHat = m[w] / (1 - std::pow(beta1, epoch));
+            double vHat = v[w] / (1 - std::pow(beta2, epoch));
+            weights[w] -= rate * mHat / (std::sqrt(vHat) + epsilon);
+        }
+        centreTables(weights);
+        if(epoch % 100 == 0 || epoch == epochs) {
+            std::cout << "Epoch " << epoch << ": loss " << std::setprecision(6) << loss << ", material";
+            for(int p = 0; p < 5; p++) {
+                std::cout << " " << (int)std::lround(weights[p]);
+            }
+            std::cout << std::endl;
+        }
+    }
+    loss = computeLoss(data, weights, k, threads, nullptr);
+
+    if(!writeHeader(output, weights, data.size(), loss)) {
+        std::cerr << "Could not write " << output << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << output << std::endl;
+    return 0;
+}